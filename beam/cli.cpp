@@ -404,8 +404,11 @@ int main(int argc, char* argv[])
 					}
 
 					node.m_Cfg.m_VerificationThreads = vm[cli::VERIFICATION_THREADS].as<int>();
+					node.m_Cfg.m_DecoderThreads = vm[cli::DECODER_THREADS].as<uint32_t>();
+					node.m_Cfg.m_CompactBlocks = vm[cli::COMPACT_BLOCKS].as<bool>();
 
 					node.m_Cfg.m_LogEvents = vm[cli::LOG_UTXOS].as<bool>();
+					node.m_Cfg.m_LogTraficStats_ms = vm[cli::LOG_TRAFIC_STATS].as<uint32_t>() * 1000;
 
 					std::string sKeyOwner;
 					get_parametr_with_deprecated_synonym(vm, cli::OWNER_KEY, cli::KEY_OWNER, &sKeyOwner);
@@ -531,6 +534,12 @@ int main(int argc, char* argv[])
 					if (vm.count(cli::VACUUM))
 						node.m_Cfg.m_ProcessorParams.m_Vacuum = vm[cli::VACUUM].as<bool>();
 
+					if (vm.count(cli::IMAGE_CHECKPOINT_PERIOD))
+						node.m_Cfg.m_ImageCheckpoints.m_Period = vm[cli::IMAGE_CHECKPOINT_PERIOD].as<uint32_t>();
+
+					if (vm.count(cli::IMAGE_CHECKPOINT_COPY))
+						node.m_Cfg.m_ImageCheckpoints.m_AllowCopy = vm[cli::IMAGE_CHECKPOINT_COPY].as<bool>();
+
 					if (vm.count(cli::RESET_ID))
 						node.m_Cfg.m_ProcessorParams.m_ResetSelfID = vm[cli::RESET_ID].as<bool>();
 
@@ -580,6 +589,9 @@ int main(int argc, char* argv[])
 						node.m_Cfg.m_ProcessorParams.m_RichInfoFlags |= NodeProcessor::StartParams::RichInfo::UpdShader;
 					}
 
+					if (vm.count(cli::SNAPSHOT_IMPORT_PATH))
+						node.m_Cfg.m_ProcessorParams.m_sSnapshot = vm[cli::SNAPSHOT_IMPORT_PATH].as<string>();
+
 					node.m_Cfg.m_pExternalPOW = stratumServer.get();
 
 					node.Initialize();
@@ -621,6 +633,16 @@ int main(int argc, char* argv[])
 						BEAM_LOG_INFO() << "Recovery info written";
 					}
 
+					if (vm.count(cli::SNAPSHOT_EXPORT_PATH))
+					{
+						string sPath = vm[cli::SNAPSHOT_EXPORT_PATH].as<string>();
+						BEAM_LOG_INFO() << "Writing state snapshot...";
+						if (node.GenerateSnapshot(sPath.c_str()))
+							BEAM_LOG_INFO() << "State snapshot written";
+						else
+							BEAM_LOG_WARNING() << "State snapshot not available";
+					}
+
 					if (vm.count(cli::RECOVERY_AUTO_PATH))
 					{
 						node.m_Cfg.m_Recovery.m_sPathOutput = vm[cli::RECOVERY_AUTO_PATH].as<string>();
@@ -117,9 +117,24 @@ namespace bvm2 {
 			size_t m_Consumed = 0;
 			ByteBuffer m_Buf;
 
+			// accumulates the whole enumeration for the cache. Not set if served from it
+			bool m_Record = false;
+			ByteBuffer m_Recorded;
+			VarsCache::Range m_Range;
+			ECC::Hash::Value m_hvContext;
+
 			bool MoveNext() override
 			{
-				assert(m_pRequest);
+				if (!m_pRequest)
+				{
+					// served from cache
+					if (m_Consumed == m_Buf.size())
+						return false;
+
+					ReadNext();
+					return true;
+				}
+
 				auto& r = Cast::Up<proto::FlyClient::RequestContractVars>(*m_pRequest);
 
 				if (m_Consumed == m_Buf.size())
@@ -128,12 +143,40 @@ namespace bvm2 {
 						return false;
 
 					if (r.m_Res.m_Result.empty())
+					{
+						if (m_Record)
+						{
+							m_Record = false;
+							m_This.m_VarsCache.Insert(m_hvContext, std::move(m_Range), std::move(m_Recorded));
+						}
 						return false;
+					}
 
 					m_Consumed = 0;
 					m_Buf = std::move(r.m_Res.m_Result);
+
+					if (m_Record)
+						m_Recorded.insert(m_Recorded.end(), m_Buf.begin(), m_Buf.end());
 				}
 
+				ReadNext();
+
+				if ((m_Consumed == m_Buf.size()) && r.m_Res.m_bMore)
+				{
+					r.m_Res.m_bMore = false;
+
+					// ask for more
+					m_LastKey.Export(r.m_Msg.m_KeyMin);
+					r.m_Msg.m_bSkipMin = true;
+
+					Post();
+				}
+
+				return true;
+			}
+
+			void ReadNext()
+			{
 				auto* pBuf = &m_Buf.front();
 
 				Deserializer der;
@@ -154,19 +197,6 @@ namespace bvm2 {
 
 				m_LastVal.p = pBuf + m_Consumed;
 				m_Consumed += m_LastVal.n;
-
-				if ((m_Consumed == m_Buf.size()) && r.m_Res.m_bMore)
-				{
-					r.m_Res.m_bMore = false;
-
-					// ask for more
-					m_LastKey.Export(r.m_Msg.m_KeyMin);
-					r.m_Msg.m_bSkipMin = true;
-
-					Post();
-				}
-
-				return true;
 			}
 		};
 
@@ -282,16 +312,78 @@ namespace bvm2 {
 		return pRet;
 	}
 
+	void ManagerStd::VarsCache::Clear()
+	{
+		m_Map.clear();
+		m_Bytes = 0;
+	}
+
+	void ManagerStd::VarsCache::SetContext(const ECC::Hash::Value& hv)
+	{
+		if (m_Valid && (m_hvContext == hv))
+			return;
+
+		Clear();
+		m_hvContext = hv;
+		m_Valid = true;
+	}
+
+	const ByteBuffer* ManagerStd::VarsCache::Find(const Blob& kMin, const Blob& kMax) const
+	{
+		if (!m_Valid || m_Map.empty())
+			return nullptr;
+
+		Range key;
+		kMin.Export(key.first);
+		kMax.Export(key.second);
+
+		auto it = m_Map.find(key);
+		return (m_Map.end() == it) ? nullptr : &it->second;
+	}
+
+	void ManagerStd::VarsCache::Insert(const ECC::Hash::Value& hvCtx, Range&& key, ByteBuffer&& buf)
+	{
+		if (!m_Valid || (m_hvContext != hvCtx))
+			return; // context changed while the enumeration was in progress
+
+		size_t nSize = key.first.size() + key.second.size() + buf.size();
+		if (nSize > s_BytesMax / 4)
+			return;
+
+		if (m_Bytes + nSize > s_BytesMax)
+			Clear();
+
+		auto res = m_Map.emplace(std::move(key), std::move(buf));
+		if (res.second)
+			m_Bytes += nSize;
+	}
+
 	void ManagerStd::VarsEnum(const Blob& kMin, const Blob& kMax, IReadVars::Ptr& pOut)
 	{
 		auto p = std::make_unique<RemoteRead::Vars>(*this);
 
+		const auto* pCached = m_VarsCache.Find(kMin, kMax);
+		if (pCached)
+		{
+			p->m_Buf = *pCached;
+			pOut = std::move(p);
+			return;
+		}
+
 		boost::intrusive_ptr<proto::FlyClient::RequestContractVars> pReq(new proto::FlyClient::RequestContractVars);
 		auto& r = *pReq;
 
 		kMin.Export(r.m_Msg.m_KeyMin);
 		kMax.Export(r.m_Msg.m_KeyMax);
 
+		if (m_VarsCache.m_Valid)
+		{
+			p->m_Record = true;
+			p->m_Range.first = r.m_Msg.m_KeyMin;
+			p->m_Range.second = r.m_Msg.m_KeyMax;
+			p->m_hvContext = m_VarsCache.m_hvContext;
+		}
+
 		SetParentContext(r.m_pCtx);
 		p->m_pRequest = std::move(pReq);
 		p->Post();
@@ -371,6 +463,14 @@ namespace bvm2 {
 				const auto* pV = m_pNetwork->get_DependentState(n);
 				const auto& hvCtx = n ? pV[n - 1] : s.m_Prev;
 				m_Context.m_pParent = std::make_unique<beam::Merkle::Hash>(hvCtx);
+
+				m_VarsCache.SetContext(hvCtx);
+			}
+			else
+			{
+				ECC::Hash::Value hv;
+				s.get_Hash(hv);
+				m_VarsCache.SetContext(hv);
 			}
 		}
 	}
@@ -52,6 +52,25 @@ namespace beam::bvm2 {
 
 		struct RemoteRead;
 
+		// Completed VarsEnum results, valid for a specific state (tip or dependent context)
+		struct VarsCache
+		{
+			typedef std::pair<ByteBuffer, ByteBuffer> Range;
+
+			std::map<Range, ByteBuffer> m_Map;
+			ECC::Hash::Value m_hvContext;
+			size_t m_Bytes = 0;
+			bool m_Valid = false;
+
+			static const size_t s_BytesMax = 0x400000;
+
+			void Clear();
+			void SetContext(const ECC::Hash::Value&);
+			const ByteBuffer* Find(const Blob& kMin, const Blob& kMax) const;
+			void Insert(const ECC::Hash::Value& hvCtx, Range&&, ByteBuffer&&);
+
+		} m_VarsCache;
+
 		void SetParentContext(std::unique_ptr<beam::Merkle::Hash>& pTrg) const;
 		void PerformSingleRequest(proto::FlyClient::Request& r);
 		proto::FlyClient::Request::Ptr GetResSingleRequest();
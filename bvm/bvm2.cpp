@@ -17,6 +17,7 @@
 #include <sstream>
 #include <iomanip>
 #include <string>
+#include <atomic>
 #include <re2/re2.h>
 #include <boost/algorithm/string/replace.hpp>
 
@@ -131,6 +132,100 @@ namespace bvm2 {
 		get_CidViaSid(cid, sid, args);
 	}
 
+	/////////////////////////////////////////////
+	// CodeCache
+	CodeCache& CodeCache::get()
+	{
+		static CodeCache s_Cache;
+		return s_Cache;
+	}
+
+	uint64_t CodeCache::get_NewStamp()
+	{
+		static std::atomic<uint64_t> s_Stamp(0);
+		return ++s_Stamp;
+	}
+
+	void CodeCache::Delete(EntryMap::iterator it)
+	{
+		Entry& x = it->second;
+		m_Bytes -= x.m_pImage->m_Body.size();
+		m_Mru.erase(MruList::s_iterator_to(x));
+		m_Map.erase(it);
+	}
+
+	void CodeCache::ShrinkTo(size_t nBytes)
+	{
+		while (!m_Mru.empty() && (m_Bytes > nBytes))
+			Delete(m_Map.find(m_Mru.back().m_pImage->m_Cid));
+	}
+
+	CodeCache::ImagePtr CodeCache::Get(const ContractID& cid, const Blob& code, uint64_t nStamp /* = 0 */)
+	{
+		std::unique_lock<std::mutex> scope(m_Mutex);
+
+		auto it = m_Map.find(cid);
+		if (m_Map.end() != it)
+		{
+			Entry& x = it->second;
+
+			bool bMatch = nStamp && (x.m_Stamp == nStamp);
+			if (!bMatch)
+			{
+				const auto& body = x.m_pImage->m_Body;
+				bMatch = (body.size() == code.n) && (body.empty() || !memcmp(&body.front(), code.p, code.n));
+
+				if (bMatch)
+					x.m_Stamp = nStamp; // next time no need to compare
+			}
+
+			if (bMatch)
+			{
+				m_Mru.erase(MruList::s_iterator_to(x));
+				m_Mru.push_front(x);
+				return x.m_pImage;
+			}
+
+			Delete(it); // code changed
+		}
+
+		auto pImage = std::make_shared<Image>();
+		pImage->m_Cid = cid;
+		code.Export(pImage->m_Body);
+		get_ShaderID(pImage->m_Sid, code);
+
+		if (code.n && (code.n <= m_BytesMax / 4)) // don't let a single image flush everything
+		{
+			Entry& x = m_Map[cid];
+			x.m_pImage = pImage;
+			x.m_Stamp = nStamp;
+
+			m_Mru.push_front(x);
+			m_Bytes += code.n;
+
+			ShrinkTo(m_BytesMax);
+		}
+
+		return pImage;
+	}
+
+	void CodeCache::Invalidate(const ContractID& cid)
+	{
+		std::unique_lock<std::mutex> scope(m_Mutex);
+
+		auto it = m_Map.find(cid);
+		if (m_Map.end() != it)
+			Delete(it);
+	}
+
+	void CodeCache::set_BytesMax(size_t n)
+	{
+		std::unique_lock<std::mutex> scope(m_Mutex);
+
+		m_BytesMax = n;
+		ShrinkTo(n);
+	}
+
 	/////////////////////////////////////////////
 	// Processor
 #pragma pack (push, 1)
@@ -292,9 +387,15 @@ namespace bvm2 {
 		x.m_StackPosMin = m_Stack.m_PosMin;
 		m_Stack.m_PosMin = m_Stack.m_Pos;
 
-		get_Storage().LoadVar(cid, m_Code);
-		m_Code.Export(x.m_Body);
-		m_Code = x.m_Body; // important! Use our local copy to access the code
+		auto& s = get_Storage();
+		s.LoadVar(cid, m_Code);
+
+		uint64_t nStamp = 0;
+		if (!s.get_CodeStamp(cid, nStamp))
+			nStamp = 0;
+
+		x.m_pImage = CodeCache::get().Get(cid, m_Code, nStamp);
+		m_Code = x.m_pImage->m_Body; // important! Use the immutable image to access the code
 
 		const Header& hdr = ParseMod();
 		Exc::Test(iMethod < ByteOrder::from_le(hdr.m_NumMethods));
@@ -344,10 +445,11 @@ namespace bvm2 {
 		}
 
 		m_FarCalls.m_Stack.Delete(x);
+		m_RunStop = true; // let the caller re-evaluate its run condition
 
 		if (!m_FarCalls.m_Stack.empty())
 		{
-			m_Code = m_FarCalls.m_Stack.back().m_Body;
+			m_Code = m_FarCalls.m_Stack.back().m_pImage->m_Body;
 			ParseMod(); // restore code/data sections
 
 			Processor::OnRet(nRetAddr);
@@ -374,8 +476,7 @@ namespace bvm2 {
 		{
 			const auto& fr = *itF;
 
-			bvm2::ShaderID sid;
-			bvm2::get_ShaderID(sid, fr.m_Body); // theoretically m_Body may be different, the contract code may modify itself. Never mind.
+			const auto& sid = fr.m_pImage->m_Sid; // theoretically the stored code may be different, the contract code may modify itself. Never mind.
 
 			os << std::endl << "Cid=" << fr.m_Cid << ", Sid=" << sid;
 
@@ -454,6 +555,14 @@ namespace bvm2 {
 		DischargeUnits(size * Limits::Cost::MemOpPerByte);
 	}
 
+	void ProcessorContract::RunCharged()
+	{
+		RunBatch(m_Charge, Limits::Cost::Cycle);
+
+		if (!m_RunStop)
+			DischargeUnits(Limits::Cost::Cycle); // charge is insufficient for the next instruction, fail the standard way
+	}
+
 	void ProcessorContract::DischargeUnits(uint32_t n)
 	{
 		if (m_Charge < n)
@@ -1179,7 +1288,15 @@ namespace bvm2 {
 
 	Processor::Heap::Entry* Processor::Heap::Create(uint32_t nPos, uint32_t nSize, bool bFree)
 	{
-		auto* p = new Heap::Entry;
+		Entry* p;
+		if (m_vSpare.empty())
+			p = new Heap::Entry;
+		else
+		{
+			p = m_vSpare.back();
+			m_vSpare.pop_back();
+		}
+
 		p->m_Pos.m_Key = nPos;
 		p->m_Size.m_Key = nSize;
 		Insert(*p, bFree);
@@ -1192,17 +1309,36 @@ namespace bvm2 {
 		Exc::Test(m_mapAllocated.end() != it);
 
 		auto& e = it->get_ParentObj();
-		Remove(e, false);
-		Insert(e, true);
+		m_mapAllocated.erase(it);
 
-		TryMerge(e);
+		// Merge with the free neighbours before inserting into the size map. The resulting layout and the order of equal-sized free blocks are the same
+		// as if the block was inserted and then merged, but with less tree operations.
+		it = m_mapFree.insert(e.m_Pos);
+
+		auto itNext = it;
+		if (m_mapFree.end() != ++itNext)
+		{
+			auto& e2 = itNext->get_ParentObj();
+			if (e.m_Pos.m_Key + e.m_Size.m_Key == e2.m_Pos.m_Key)
+			{
+				e.m_Size.m_Key += e2.m_Size.m_Key;
+				Delete(e2, true);
+			}
+		}
 
-		it = MapPos::s_iterator_to(e.m_Pos);
 		if (m_mapFree.begin() != it)
 		{
-			--it;
-			TryMerge(it->get_ParentObj());
+			auto& e0 = (--it)->get_ParentObj();
+			if (e0.m_Pos.m_Key + e0.m_Size.m_Key == e.m_Pos.m_Key)
+			{
+				UpdateSizeFree(e0, e0.m_Size.m_Key + e.m_Size.m_Key);
+				m_mapFree.erase(MapPos::s_iterator_to(e.m_Pos));
+				Recycle(e);
+				return;
+			}
 		}
+
+		m_mapSize.insert(e.m_Size);
 	}
 
 	void Processor::Heap::Test(uint32_t ptr, uint32_t size)
@@ -1225,17 +1361,6 @@ namespace bvm2 {
 		m_mapSize.insert(e.m_Size);
 	}
 
-	void Processor::Heap::TryMerge(Entry& e)
-	{
-		auto it = m_mapFree.find(e.m_Pos.m_Key + e.m_Size.m_Key, Entry::Pos::Comparator());
-		if (m_mapFree.end() != it)
-		{
-			auto& e2 = it->get_ParentObj();
-			UpdateSizeFree(e, e.m_Size.m_Key + e2.m_Size.m_Key);
-			Delete(e2, true);
-		}
-	}
-
 	void Processor::Heap::Insert(Entry& e, bool bFree)
 	{
 		if (bFree)
@@ -1261,7 +1386,15 @@ namespace bvm2 {
 	void Processor::Heap::Delete(Entry& e, bool bFree)
 	{
 		Remove(e, bFree);
-		delete &e;
+		Recycle(e);
+	}
+
+	void Processor::Heap::Recycle(Entry& e)
+	{
+		if (m_vSpare.size() < s_SpareMax)
+			m_vSpare.push_back(&e);
+		else
+			delete &e;
 	}
 
 	void Processor::Heap::Clear()
@@ -1272,6 +1405,10 @@ namespace bvm2 {
 		while (!m_mapAllocated.empty())
 			Delete(m_mapAllocated.begin()->get_ParentObj(), false);
 
+		for (auto* p : m_vSpare)
+			delete p;
+		m_vSpare.clear();
+
 		m_vMem.clear();
 	}
 
@@ -3954,6 +4091,8 @@ namespace bvm2 {
 	{
 		ShaderID sid;
 
+		CodeCache::get().Invalidate(cid);
+
 		auto& s = get_Storage();
 		if (pCode)
 		{
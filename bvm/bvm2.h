@@ -17,6 +17,7 @@
 #include "../utility/containers.h"
 #include "../core/block_crypt.h"
 #include "invoke_data.h"
+#include <mutex>
 
 namespace Shaders {
 
@@ -112,6 +113,9 @@ namespace bvm2 {
 			virtual void LoadVarEx(Blob& key, Blob& res, bool bExact, bool bBigger) = 0;
 			virtual uint32_t SaveVar(const Blob&, const Blob& val) = 0;
 			virtual uint32_t OnLog(const Blob&, const Blob& val) = 0;
+
+			// optional. Process-wide unique stamp of the current contract code, must change whenever the code does (see CodeCache::get_NewStamp)
+			virtual bool get_CodeStamp(const ContractID&, uint64_t& nStamp) { return false; }
 		};
 
 		struct Dummy
@@ -134,6 +138,55 @@ namespace bvm2 {
 
 	}
 
+	// Process-wide cache of immutable contract code images, shared by far-call frames (no per-call copy).
+	// Entries are validated by the code stamp of the storage, if it provides one, otherwise against the actual stored code.
+	// So that different storages can't confuse it.
+	struct CodeCache
+	{
+		struct Image
+		{
+			ContractID m_Cid;
+			ShaderID m_Sid;
+			ByteBuffer m_Body;
+		};
+
+		typedef std::shared_ptr<const Image> ImagePtr;
+
+		static CodeCache& get();
+		static uint64_t get_NewStamp(); // never 0
+
+		~CodeCache() {
+			ShrinkTo(0);
+		}
+
+		ImagePtr Get(const ContractID&, const Blob& code, uint64_t nStamp = 0); // creates/replaces the entry if necessary. nStamp: 0 if n/a
+		void Invalidate(const ContractID&);
+		void set_BytesMax(size_t);
+
+		size_t get_Bytes() const { return m_Bytes; }
+
+	private:
+
+		struct Entry
+			:public boost::intrusive::list_base_hook<>
+		{
+			ImagePtr m_pImage;
+			uint64_t m_Stamp = 0; // the code is known to be the same as long as the stamp matches
+		};
+
+		typedef std::map<ContractID, Entry> EntryMap;
+		typedef boost::intrusive::list<Entry> MruList;
+
+		std::mutex m_Mutex;
+		EntryMap m_Map;
+		MruList m_Mru;
+		size_t m_Bytes = 0;
+		size_t m_BytesMax = 0x2000000; // 32MB
+
+		void Delete(EntryMap::iterator);
+		void ShrinkTo(size_t);
+	};
+
 	class ProcessorContract;
 
 	class Processor
@@ -169,11 +222,15 @@ namespace bvm2 {
 			MapPos m_mapFree;
 			MapPos m_mapAllocated;
 
+			// recycled entries, to avoid a malloc/free per partition and merge
+			std::vector<Entry*> m_vSpare;
+			static const uint32_t s_SpareMax = 0x100;
+
 			void Insert(Entry&, bool bFree);
 			void Remove(Entry&, bool bFree);
 			void Delete(Entry&, bool bFree);
+			void Recycle(Entry&);
 			void UpdateSizeFree(Entry&, uint32_t newVal);
-			void TryMerge(Entry&);
 			Entry* Create(uint32_t nPos, uint32_t nSize, bool bFree);
 
 		public:
@@ -387,7 +444,7 @@ namespace bvm2 {
 				:public boost::intrusive::list_base_hook<>
 			{
 				ContractID m_Cid;
-				ByteBuffer m_Body;
+				CodeCache::ImagePtr m_pImage;
 				Wasm::Word m_FarRetAddr;
 				Wasm::Word m_StackPosMin;
 				Wasm::Word m_StackBytesMax;
@@ -501,6 +558,9 @@ namespace bvm2 {
 
 		uint32_t m_Charge = Limits::BlockCharge;
 
+		// Same as repeating DischargeUnits(Cost::Cycle) + RunOnce(), until the far-call stack is popped
+		void RunCharged();
+
 		virtual void CallFar(const ContractID&, uint32_t iMethod, Wasm::Word pArgs, uint32_t nArgs, uint32_t nFlags); // can override to invoke host code instead of interpretator (for debugging)
 	};
 
@@ -484,6 +484,168 @@ void Processor::BaseFrame::UpdateCode(Account& acc, const Blob& code)
 	acc.m_Code.m_Value = pOp->m_Buf;
 }
 
+/////////////////////////////////////////////
+// Limbs
+void Processor::Limbs::Import(const Word& w)
+{
+	for (uint32_t i = 0; i < s_Count; i++)
+	{
+		uint64_t x;
+		memcpy(&x, w.m_pData + Word::nBytes - sizeof(x) * (i + 1), sizeof(x));
+		m_p[i] = ByteOrder::from_be(x);
+	}
+}
+
+void Processor::Limbs::Export(Word& w) const
+{
+	for (uint32_t i = 0; i < s_Count; i++)
+	{
+		uint64_t x = ByteOrder::to_be(m_p[i]);
+		memcpy(w.m_pData + Word::nBytes - sizeof(x) * (i + 1), &x, sizeof(x));
+	}
+}
+
+void Processor::Limbs::Add(const Limbs& x)
+{
+	uint64_t nCarry = 0;
+	for (uint32_t i = 0; i < s_Count; i++)
+	{
+		uint64_t a = m_p[i] + nCarry;
+		nCarry = (a < nCarry);
+		m_p[i] = a + x.m_p[i];
+		nCarry += (m_p[i] < a);
+	}
+}
+
+void Processor::Limbs::Sub(const Limbs& x)
+{
+	uint64_t nBorrow = 0;
+	for (uint32_t i = 0; i < s_Count; i++)
+	{
+		uint64_t a = m_p[i];
+		uint64_t b = x.m_p[i] + nBorrow;
+		nBorrow = (b < nBorrow) | (a < b);
+		m_p[i] = a - b;
+	}
+}
+
+namespace
+{
+	// acc = lo(a * b + acc + carry), carry = hi(...). Never overflows 128 bits
+	void MulAcc(uint64_t a, uint64_t b, uint64_t& acc, uint64_t& nCarry)
+	{
+#ifdef __SIZEOF_INT128__
+		unsigned __int128 x = static_cast<unsigned __int128>(a) * b;
+		x += acc;
+		x += nCarry;
+		acc = static_cast<uint64_t>(x);
+		nCarry = static_cast<uint64_t>(x >> 64);
+#else // __SIZEOF_INT128__
+		uint64_t a0 = static_cast<uint32_t>(a), a1 = a >> 32;
+		uint64_t b0 = static_cast<uint32_t>(b), b1 = b >> 32;
+
+		uint64_t p00 = a0 * b0;
+		uint64_t p01 = a0 * b1;
+		uint64_t p10 = a1 * b0;
+		uint64_t p11 = a1 * b1;
+
+		uint64_t nMid = (p00 >> 32) + static_cast<uint32_t>(p01) + static_cast<uint32_t>(p10);
+		uint64_t lo = (nMid << 32) | static_cast<uint32_t>(p00);
+		uint64_t hi = p11 + (p01 >> 32) + (p10 >> 32) + (nMid >> 32);
+
+		lo += acc;
+		hi += (lo < acc);
+		lo += nCarry;
+		hi += (lo < nCarry);
+
+		acc = lo;
+		nCarry = hi;
+#endif // __SIZEOF_INT128__
+	}
+}
+
+void Processor::Limbs::SetMul(const Limbs& a, const Limbs& b)
+{
+	uint64_t pRes[s_Count] = { 0 };
+
+	for (uint32_t i = 0; i < s_Count; i++)
+	{
+		uint64_t nCarry = 0;
+		for (uint32_t j = 0; i + j < s_Count; j++)
+			MulAcc(a.m_p[i], b.m_p[j], pRes[i + j], nCarry);
+	}
+
+	memcpy(m_p, pRes, sizeof(m_p));
+}
+
+void Processor::Limbs::SetPower(const Limbs& base, const Limbs& exp)
+{
+	Limbs x = base; // may alias this
+	Limbs e = exp;
+
+	uint32_t nBits = s_Count * 64;
+	for (uint32_t i = s_Count; i-- && !e.m_p[i]; )
+		nBits -= 64;
+	if (nBits)
+	{
+		for (uint64_t v = e.m_p[(nBits >> 6) - 1]; !(v >> 63); v <<= 1)
+			nBits--;
+	}
+
+	ZeroObject(m_p);
+	m_p[0] = 1;
+
+	// square-and-multiply, lsb first
+	for (uint32_t iBit = 0; iBit < nBits; iBit++)
+	{
+		if (1 & (e.m_p[iBit >> 6] >> (63 & iBit)))
+			SetMul(*this, x);
+
+		if (iBit + 1 < nBits)
+			x.SetMul(x, x);
+	}
+}
+
+void Processor::Limbs::ShiftLeft(uint32_t nBits)
+{
+	assert(nBits < s_Count * 64);
+	uint32_t nLimbs = nBits >> 6;
+	nBits &= 63;
+
+	for (uint32_t i = s_Count; i--; )
+	{
+		uint64_t val = 0;
+		if (i >= nLimbs)
+		{
+			uint32_t iSrc = i - nLimbs;
+			val = m_p[iSrc] << nBits;
+			if (nBits && iSrc)
+				val |= m_p[iSrc - 1] >> (64 - nBits);
+		}
+		m_p[i] = val;
+	}
+}
+
+void Processor::Limbs::ShiftRight(uint32_t nBits)
+{
+	assert(nBits < s_Count * 64);
+	uint32_t nLimbs = nBits >> 6;
+	nBits &= 63;
+
+	for (uint32_t i = 0; i < s_Count; i++)
+	{
+		uint64_t val = 0;
+		uint32_t iSrc = i + nLimbs;
+		if (iSrc < s_Count)
+		{
+			val = m_p[iSrc] >> nBits;
+			if (nBits && (iSrc + 1 < s_Count))
+				val |= m_p[iSrc + 1] << (64 - nBits);
+		}
+		m_p[i] = val;
+	}
+}
+
 void Processor::BaseFrame::UpdateBalance(Account& acc, const Word& val1)
 {
 	if (acc.m_Balance.m_Value != val1)
@@ -697,21 +859,30 @@ OnOpcode(mulmod)
 
 OnOpcodeBinary(add)
 {
-	b += a;
+	Limbs x, y;
+	x.Import(a);
+	y.Import(b);
+	y.Add(x);
+	y.Export(b);
 }
 
 OnOpcodeBinary(mul)
 {
-	Word::Number b_;
-	b_.get_Slice().SetMul(a.ToNumber().get_ConstSlice(), b.ToNumber().get_ConstSlice());
-	b.FromNumber(b_);
+	Limbs x, y;
+	x.Import(a);
+	y.Import(b);
+	y.SetMul(x, y);
+	y.Export(b);
 }
 
 OnOpcodeBinary(sub)
 {
 	// b = a - b;
-	b.Negate();
-	b += a;
+	Limbs x, y;
+	x.Import(a);
+	y.Import(b);
+	x.Sub(y);
+	x.Export(b);
 }
 
 OnOpcodeBinary(div)
@@ -798,9 +969,11 @@ OnOpcodeBinary(exp)
 	}
 
 	// b = a ^ b
-	Word::Number res;
-	res.Power(a.ToNumber(), b.ToNumber());
-	b.FromNumber(res);
+	Limbs x, y;
+	x.Import(a);
+	y.Import(b);
+	y.SetPower(x, y);
+	y.Export(b);
 }
 
 OnOpcodeBinary(signextend)
@@ -844,18 +1017,24 @@ OnOpcodeBinary(eq)
 
 OnOpcodeBinary(shl)
 {
-	auto x = b;
 	auto n = WtoU32(a);
-	Test(n < x.nBits);
-	x.ShiftLeft(n, b);
+	Test(n < b.nBits);
+
+	Limbs x;
+	x.Import(b);
+	x.ShiftLeft(n);
+	x.Export(b);
 }
 
 OnOpcodeBinary(shr)
 {
-	auto x = b;
 	auto n = WtoU32(a);
-	Test(n < x.nBits);
-	x.ShiftRight(n, b);
+	Test(n < b.nBits);
+
+	Limbs x;
+	x.Import(b);
+	x.ShiftRight(n);
+	x.Export(b);
 }
 
 OnOpcodeBinary(sar)
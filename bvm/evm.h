@@ -100,6 +100,23 @@ namespace Evm {
 
 		};
 
+		// Word as native 64-bit limbs, for the hot arithmetic opcodes. All the operations are modulo 2^256
+		struct Limbs
+		{
+			static const uint32_t s_Count = Word::nBytes / sizeof(uint64_t);
+			uint64_t m_p[s_Count]; // least significant first
+
+			void Import(const Word&);
+			void Export(Word&) const;
+
+			void Add(const Limbs&);
+			void Sub(const Limbs&);
+			void SetMul(const Limbs&, const Limbs&);
+			void SetPower(const Limbs& base, const Limbs& exp);
+			void ShiftLeft(uint32_t nBits); // nBits < 256
+			void ShiftRight(uint32_t nBits); // nBits < 256
+		};
+
 		struct Account
 			:public intrusive::set_base_hook<Address>
 		{
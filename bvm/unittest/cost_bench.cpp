@@ -0,0 +1,775 @@
+// Copyright 2018 The Beam Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Gas-vs-time calibration for the bvm2 cost table (bvm2_cost.h).
+// Every case is a contract method that repeats a single instruction class or host call in an endless loop, and runs until the whole block charge is consumed.
+// So each line reports the validation time of a block stuffed with this operation, and the resulting ns per charge unit.
+// Cases that are much more expensive per unit than the median are underpriced, and bound the worst-case block validation time.
+
+#define HOST_BUILD
+
+#include "../../utility/blobmap.h"
+#include "../bvm2.h"
+#include <chrono>
+#include <iomanip>
+#include <algorithm>
+
+namespace beam::bvm2 {
+
+	struct WasmBuilder
+	{
+		ByteBuffer m_Res;
+
+		struct TypeCode {
+			static const uint8_t i32 = 0x7f;
+			static const uint8_t i64 = 0x7e;
+		};
+
+		struct Op {
+			static const uint8_t Loop = 0x03;
+			static const uint8_t Br = 0x0c;
+			static const uint8_t End = 0x0b;
+			static const uint8_t Call = 0x10;
+			static const uint8_t Drop = 0x1a;
+			static const uint8_t LocalGet = 0x20;
+			static const uint8_t LocalSet = 0x21;
+			static const uint8_t LocalTee = 0x22;
+			static const uint8_t GlobalGet = 0x23;
+			static const uint8_t GlobalSet = 0x24;
+			static const uint8_t I32Load = 0x28;
+			static const uint8_t I32Store = 0x36;
+			static const uint8_t I32Const = 0x41;
+			static const uint8_t I64Const = 0x42;
+			static const uint8_t I32Add = 0x6a;
+			static const uint8_t I32Sub = 0x6b;
+			static const uint8_t I32Mul = 0x6c;
+			static const uint8_t I64Add = 0x7c;
+			static const uint8_t I64Mul = 0x7e;
+			static const uint8_t I64DivU = 0x80;
+		};
+
+		void Put(uint8_t x) {
+			m_Res.push_back(x);
+		}
+
+		void PutU(uint64_t x)
+		{
+			for (; x >= 0x80; x >>= 7)
+				Put(static_cast<uint8_t>(x) | 0x80);
+			Put(static_cast<uint8_t>(x));
+		}
+
+		void PutS(int64_t x)
+		{
+			while (true)
+			{
+				uint8_t n = static_cast<uint8_t>(x) & 0x7f;
+				x >>= 7; // arithmetic shift
+
+				if ((!x && !(0x40 & n)) || ((-1 == x) && (0x40 & n)))
+				{
+					Put(n);
+					break;
+				}
+
+				Put(n | 0x80);
+			}
+		}
+
+		void Put(const Blob& x) {
+			m_Res.insert(m_Res.end(), reinterpret_cast<const uint8_t*>(x.p), reinterpret_cast<const uint8_t*>(x.p) + x.n);
+		}
+
+		void PutStr(const char* sz)
+		{
+			uint32_t n = static_cast<uint32_t>(strlen(sz));
+			PutU(n);
+			Put(Blob(sz, n));
+		}
+
+		// Instructions
+		void I32Const(int32_t x) { Put(Op::I32Const); PutS(x); }
+		void I64Const(int64_t x) { Put(Op::I64Const); PutS(x); }
+		void Local(uint8_t nOp, uint32_t i) { Put(nOp); PutU(i); }
+		void Call(uint32_t iFunc) { Put(Op::Call); PutU(iFunc); }
+		void Mem(uint8_t nOp, uint32_t nOffset) { Put(nOp); PutU(2); PutU(nOffset); } // 4-byte aligned
+
+		void Section(uint8_t nID, const WasmBuilder& x)
+		{
+			Put(nID);
+			PutU(x.m_Res.size());
+			Put(x.m_Res);
+		}
+	};
+
+	struct CostBench
+		:public ProcessorContract
+	{
+		BlobMap::Set m_Vars;
+
+		void LoadVar(const Blob& key, Blob& res) override
+		{
+			auto* pE = m_Vars.Find(key);
+			if (pE)
+				res = pE->m_Data;
+			else
+				res.n = 0;
+		}
+
+		void LoadVarEx(Blob& key, Blob& res, bool bExact, bool bBigger) override
+		{
+			auto pE = m_Vars.FindVarEx(key, bExact, bBigger);
+			if (pE)
+			{
+				key = pE->ToBlob();
+				res = pE->m_Data;
+			}
+			else
+			{
+				key.n = 0;
+				res.n = 0;
+			}
+		}
+
+		uint32_t SaveVar(const Blob& key, const Blob& val) override
+		{
+			auto* pE = m_Vars.Find(key);
+			auto nOldSize = pE ? static_cast<uint32_t>(pE->m_Data.size()) : 0;
+
+			if (val.n)
+			{
+				if (!pE)
+					pE = m_Vars.Create(key);
+				val.Export(pE->m_Data);
+			}
+			else
+			{
+				if (pE)
+					m_Vars.Delete(*pE);
+			}
+
+			return nOldSize;
+		}
+
+		uint32_t OnLog(const Blob&, const Blob&) override {
+			return 0;
+		}
+
+		// Imported host functions, in the import order
+		struct Import
+		{
+			enum Enum {
+				HashCreateSha256,
+				HashCreateKeccak,
+				HashCreateBlake2b,
+				HashWrite,
+				HashGetValue,
+				HashFree,
+				Memcpy,
+				Heap_Alloc,
+				Heap_Free,
+				LoadVar,
+				SaveVar,
+				Secp_Scalar_alloc,
+				Secp_Scalar_set,
+				Secp_Scalar_inv,
+				Secp_Point_alloc,
+				Secp_Point_mul_G,
+				Secp_Point_mul,
+				Secp_Point_Import,
+				Secp_Point_Export,
+				CallFar,
+				count
+			};
+		};
+
+		// local function layout: Ctor, Dtor, Method_2 (empty, far call target), local empty func, then the cases as Method_3...
+		static const uint32_t s_iFuncLocal = Import::count + 3;
+		static const uint32_t s_iMethod0 = 3;
+
+		static const uint32_t s_BufSize = 0x800; // alias stack scratch, allocated by each case
+
+		// locals: 0 = args (cid), 1 = scratch buf, 2,3 = i32 handles, 4 = i64
+		struct Local {
+			static const uint32_t Args = 0;
+			static const uint32_t Buf = 1;
+			static const uint32_t H1 = 2;
+			static const uint32_t H2 = 3;
+			static const uint32_t V64 = 4;
+		};
+
+		struct Case
+		{
+			const char* m_szName;
+			void (*m_pfnSetup)(WasmBuilder&);
+			void (*m_pfnBody)(WasmBuilder&);
+		};
+
+		static void HashCycle(WasmBuilder& wb, uint32_t nSize)
+		{
+			typedef WasmBuilder::Op Op;
+
+			wb.Local(Op::LocalTee, Local::H1);
+			wb.Local(Op::LocalGet, Local::Buf);
+			wb.I32Const(nSize);
+			wb.Call(Import::HashWrite);
+			wb.Local(Op::LocalGet, Local::H1);
+			wb.Local(Op::LocalGet, Local::Buf);
+			wb.I32Const(32);
+			wb.Call(Import::HashGetValue);
+			wb.Local(Op::LocalGet, Local::H1);
+			wb.Call(Import::HashFree);
+		}
+
+		static void SetupScalar(WasmBuilder& wb)
+		{
+			typedef WasmBuilder::Op Op;
+
+			wb.Call(Import::Secp_Scalar_alloc);
+			wb.Local(Op::LocalTee, Local::H1);
+			wb.I64Const(0x123456789abcdefll);
+			wb.Call(Import::Secp_Scalar_set);
+		}
+
+		static void SetupPoint(WasmBuilder& wb)
+		{
+			typedef WasmBuilder::Op Op;
+
+			SetupScalar(wb);
+			wb.Call(Import::Secp_Point_alloc);
+			wb.Local(Op::LocalTee, Local::H2);
+			wb.Local(Op::LocalGet, Local::H1);
+			wb.Call(Import::Secp_Point_mul_G);
+		}
+
+		static void PushVarArgs(WasmBuilder& wb)
+		{
+			typedef WasmBuilder::Op Op;
+
+			// key: 8 bytes at buf, value: 32 bytes at buf+64, internal tag
+			wb.Local(Op::LocalGet, Local::Buf);
+			wb.I32Const(8);
+			wb.Local(Op::LocalGet, Local::Buf);
+			wb.I32Const(64);
+			wb.Put(Op::I32Add);
+			wb.I32Const(32);
+			wb.I32Const(0);
+		}
+
+		static const Case s_pCases[];
+		static const uint32_t s_Cases;
+
+		static void BuildModule(ByteBuffer&);
+
+		struct Result
+		{
+			const char* m_szName;
+			uint64_t m_Units;
+			double m_Ns;
+
+			double get_NsPerUnit() const {
+				return m_Units ? (m_Ns / m_Units) : 0.;
+			}
+		};
+
+		ContractID m_Cid;
+
+		void Deploy();
+		bool RunCase(uint32_t iCase, Result&);
+		void RunAll(uint32_t nRuns, double dOutlier);
+	};
+
+	const CostBench::Case CostBench::s_pCases[] = {
+
+		{ "i32 arith", nullptr, [](WasmBuilder& wb) {
+			typedef WasmBuilder::Op Op;
+			wb.Local(Op::LocalGet, Local::H1);
+			wb.I32Const(3);
+			wb.Put(Op::I32Mul);
+			wb.I32Const(7);
+			wb.Put(Op::I32Add);
+			wb.Local(Op::LocalSet, Local::H1);
+		} },
+
+		{ "i64 arith", nullptr, [](WasmBuilder& wb) {
+			typedef WasmBuilder::Op Op;
+			wb.Local(Op::LocalGet, Local::V64);
+			wb.I64Const(3);
+			wb.Put(Op::I64Mul);
+			wb.I64Const(7);
+			wb.Put(Op::I64Add);
+			wb.Local(Op::LocalSet, Local::V64);
+		} },
+
+		{ "i64 div", nullptr, [](WasmBuilder& wb) {
+			typedef WasmBuilder::Op Op;
+			wb.Local(Op::LocalGet, Local::V64);
+			wb.I64Const(0x7fffffffffffll);
+			wb.Put(Op::I64Add);
+			wb.I64Const(3);
+			wb.Put(Op::I64DivU);
+			wb.Local(Op::LocalSet, Local::V64);
+		} },
+
+		{ "mem load/store", nullptr, [](WasmBuilder& wb) {
+			typedef WasmBuilder::Op Op;
+			wb.Local(Op::LocalGet, Local::Buf);
+			wb.Local(Op::LocalGet, Local::Buf);
+			wb.Mem(Op::I32Load, 0);
+			wb.I32Const(1);
+			wb.Put(Op::I32Add);
+			wb.Mem(Op::I32Store, 0);
+		} },
+
+		{ "local call", nullptr, [](WasmBuilder& wb) {
+			wb.Call(s_iFuncLocal);
+		} },
+
+		{ "Memcpy 1K", nullptr, [](WasmBuilder& wb) {
+			typedef WasmBuilder::Op Op;
+			wb.Local(Op::LocalGet, Local::Buf);
+			wb.Local(Op::LocalGet, Local::Buf);
+			wb.I32Const(0x400);
+			wb.Put(Op::I32Add);
+			wb.I32Const(0x400);
+			wb.Call(Import::Memcpy);
+			wb.Put(Op::Drop);
+		} },
+
+		{ "Heap alloc/free", nullptr, [](WasmBuilder& wb) {
+			wb.I32Const(64);
+			wb.Call(Import::Heap_Alloc);
+			wb.Call(Import::Heap_Free);
+		} },
+
+		{ "Sha256 32b", nullptr, [](WasmBuilder& wb) {
+			wb.Call(Import::HashCreateSha256);
+			HashCycle(wb, 32);
+		} },
+
+		{ "Keccak256 32b", nullptr, [](WasmBuilder& wb) {
+			wb.I32Const(256);
+			wb.Call(Import::HashCreateKeccak);
+			HashCycle(wb, 32);
+		} },
+
+		{ "Blake2b 32b", nullptr, [](WasmBuilder& wb) {
+			wb.I32Const(0);
+			wb.I32Const(0);
+			wb.I32Const(32);
+			wb.Call(Import::HashCreateBlake2b);
+			HashCycle(wb, 32);
+		} },
+
+		{ "HashWrite 2K", [](WasmBuilder& wb) {
+			typedef WasmBuilder::Op Op;
+			wb.Call(Import::HashCreateSha256);
+			wb.Local(Op::LocalSet, Local::H1);
+		}, [](WasmBuilder& wb) {
+			typedef WasmBuilder::Op Op;
+			wb.Local(Op::LocalGet, Local::H1);
+			wb.Local(Op::LocalGet, Local::Buf);
+			wb.I32Const(s_BufSize);
+			wb.Call(Import::HashWrite);
+		} },
+
+		{ "LoadVar 32b", [](WasmBuilder& wb) {
+			PushVarArgs(wb);
+			wb.Call(Import::SaveVar);
+			wb.Put(WasmBuilder::Op::Drop);
+		}, [](WasmBuilder& wb) {
+			PushVarArgs(wb);
+			wb.Call(Import::LoadVar);
+			wb.Put(WasmBuilder::Op::Drop);
+		} },
+
+		{ "SaveVar 32b", nullptr, [](WasmBuilder& wb) {
+			typedef WasmBuilder::Op Op;
+			// modify the value each time
+			wb.Local(Op::LocalGet, Local::Buf);
+			wb.Local(Op::LocalGet, Local::Buf);
+			wb.Mem(Op::I32Load, 64);
+			wb.I32Const(1);
+			wb.Put(Op::I32Add);
+			wb.Mem(Op::I32Store, 64);
+
+			PushVarArgs(wb);
+			wb.Call(Import::SaveVar);
+			wb.Put(Op::Drop);
+		} },
+
+		{ "Secp scalar inv", SetupScalar, [](WasmBuilder& wb) {
+			typedef WasmBuilder::Op Op;
+			wb.Local(Op::LocalGet, Local::H1);
+			wb.Local(Op::LocalGet, Local::H1);
+			wb.Call(Import::Secp_Scalar_inv);
+		} },
+
+		{ "Secp mul G", SetupPoint, [](WasmBuilder& wb) {
+			typedef WasmBuilder::Op Op;
+			wb.Local(Op::LocalGet, Local::H2);
+			wb.Local(Op::LocalGet, Local::H1);
+			wb.Call(Import::Secp_Point_mul_G);
+		} },
+
+		{ "Secp point mul", SetupPoint, [](WasmBuilder& wb) {
+			typedef WasmBuilder::Op Op;
+			wb.Local(Op::LocalGet, Local::H2);
+			wb.Local(Op::LocalGet, Local::H2);
+			wb.Local(Op::LocalGet, Local::H1);
+			wb.Call(Import::Secp_Point_mul);
+		} },
+
+		{ "Secp point export/import", SetupPoint, [](WasmBuilder& wb) {
+			typedef WasmBuilder::Op Op;
+			wb.Local(Op::LocalGet, Local::H2);
+			wb.Local(Op::LocalGet, Local::Buf);
+			wb.Call(Import::Secp_Point_Export);
+			wb.Local(Op::LocalGet, Local::H2);
+			wb.Local(Op::LocalGet, Local::Buf);
+			wb.Call(Import::Secp_Point_Import);
+			wb.Put(Op::Drop);
+		} },
+
+		{ "CallFar", nullptr, [](WasmBuilder& wb) {
+			typedef WasmBuilder::Op Op;
+			wb.Local(Op::LocalGet, Local::Args); // own cid
+			wb.I32Const(2);
+			wb.Local(Op::LocalGet, Local::Args);
+			wb.I32Const(0);
+			wb.I32Const(0);
+			wb.Call(Import::CallFar);
+		} },
+	};
+
+	const uint32_t CostBench::s_Cases = static_cast<uint32_t>(_countof(CostBench::s_pCases));
+
+	void CostBench::BuildModule(ByteBuffer& res)
+	{
+		typedef WasmBuilder::Op Op;
+		typedef WasmBuilder::TypeCode TC;
+
+		// function types
+		struct Type {
+			enum Enum {
+				Method, // (i32)
+				Void, // ()
+				R_Void, // () -> i32
+				R_1, // (i32) -> i32
+				R_3, // (i32, i32, i32) -> i32
+				V_2, // (i32, i32)
+				V_3, // (i32, i32, i32)
+				V_5, // (i32 x5)
+				R_2, // (i32, i32) -> i32
+				R_5, // (i32 x5) -> i32
+				V_1_64, // (i32, i64)
+				count
+			};
+		};
+
+		WasmBuilder wbTypes;
+		wbTypes.PutU(Type::count);
+		{
+			auto fnType = [&wbTypes](uint32_t nArgs32, bool bArg64, bool bRet) {
+				wbTypes.Put(0x60);
+				wbTypes.PutU(nArgs32 + bArg64);
+				for (uint32_t i = 0; i < nArgs32; i++)
+					wbTypes.Put(TC::i32);
+				if (bArg64)
+					wbTypes.Put(TC::i64);
+				wbTypes.PutU(bRet);
+				if (bRet)
+					wbTypes.Put(TC::i32);
+			};
+
+			fnType(1, false, false); // Method
+			fnType(0, false, false); // Void
+			fnType(0, false, true); // R_Void
+			fnType(1, false, true); // R_1
+			fnType(3, false, true); // R_3
+			fnType(2, false, false); // V_2
+			fnType(3, false, false); // V_3
+			fnType(5, false, false); // V_5
+			fnType(2, false, true); // R_2
+			fnType(5, false, true); // R_5
+			fnType(1, true, false); // V_1_64
+		}
+
+		struct ImportInfo {
+			const char* m_szName;
+			uint32_t m_iType;
+		};
+
+		static const ImportInfo s_pImports[Import::count] = {
+			{ "HashCreateSha256", Type::R_Void },
+			{ "HashCreateKeccak", Type::R_1 },
+			{ "HashCreateBlake2b", Type::R_3 },
+			{ "HashWrite", Type::V_3 },
+			{ "HashGetValue", Type::V_3 },
+			{ "HashFree", Type::Method },
+			{ "Memcpy", Type::R_3 },
+			{ "Heap_Alloc", Type::R_1 },
+			{ "Heap_Free", Type::Method },
+			{ "LoadVar", Type::R_5 },
+			{ "SaveVar", Type::R_5 },
+			{ "Secp_Scalar_alloc", Type::R_Void },
+			{ "Secp_Scalar_set", Type::V_1_64 },
+			{ "Secp_Scalar_inv", Type::V_2 },
+			{ "Secp_Point_alloc", Type::R_Void },
+			{ "Secp_Point_mul_G", Type::V_2 },
+			{ "Secp_Point_mul", Type::V_3 },
+			{ "Secp_Point_Import", Type::R_2 },
+			{ "Secp_Point_Export", Type::V_2 },
+			{ "CallFar", Type::V_5 },
+		};
+
+		WasmBuilder wbImports;
+		wbImports.PutU(Import::count);
+		for (uint32_t i = 0; i < Import::count; i++)
+		{
+			wbImports.PutStr("env");
+			wbImports.PutStr(s_pImports[i].m_szName);
+			wbImports.Put(0); // func
+			wbImports.PutU(s_pImports[i].m_iType);
+		}
+
+		uint32_t nFuncs = s_iMethod0 + 1 + s_Cases;
+
+		WasmBuilder wbFuncs;
+		wbFuncs.PutU(nFuncs);
+		for (uint32_t i = 0; i < nFuncs; i++)
+			wbFuncs.PutU((s_iMethod0 == i) ? Type::Void : Type::Method);
+
+		// the stack pointer
+		WasmBuilder wbGlobals;
+		wbGlobals.PutU(1);
+		wbGlobals.Put(TC::i32);
+		wbGlobals.Put(1); // mutable
+		wbGlobals.I32Const(0);
+		wbGlobals.Put(Op::End);
+
+		WasmBuilder wbExports;
+		wbExports.PutU(s_iMethod0 + s_Cases);
+		for (uint32_t i = 0; i < s_iMethod0 + s_Cases; i++)
+		{
+			std::string sName =
+				(0 == i) ? "Ctor" :
+				(1 == i) ? "Dtor" :
+				"Method_" + std::to_string(i);
+
+			wbExports.PutStr(sName.c_str());
+			wbExports.Put(0); // func
+			wbExports.PutU(Import::count + ((i < s_iMethod0) ? i : (i + 1)));
+		}
+
+		WasmBuilder wbCode;
+		wbCode.PutU(nFuncs);
+
+		for (uint32_t i = 0; i <= s_iMethod0; i++)
+		{
+			// empty functions
+			wbCode.PutU(2);
+			wbCode.PutU(0); // no locals
+			wbCode.Put(Op::End);
+		}
+
+		for (uint32_t iCase = 0; iCase < s_Cases; iCase++)
+		{
+			const auto& c = s_pCases[iCase];
+
+			WasmBuilder wb;
+			wb.PutU(2); // local groups
+			wb.PutU(3);
+			wb.Put(TC::i32);
+			wb.PutU(1);
+			wb.Put(TC::i64);
+
+			// allocate the scratch buffer on the alias stack
+			wb.Local(Op::GlobalGet, 0);
+			wb.I32Const(s_BufSize * 2);
+			wb.Put(Op::I32Sub);
+			wb.Local(Op::LocalTee, Local::Buf);
+			wb.Local(Op::GlobalSet, 0);
+
+			if (c.m_pfnSetup)
+				c.m_pfnSetup(wb);
+
+			// endless loop, terminated by the charge exhaustion
+			wb.Put(Op::Loop);
+			wb.Put(0x40); // void
+			c.m_pfnBody(wb);
+			wb.Put(Op::Br);
+			wb.PutU(0);
+			wb.Put(Op::End);
+
+			wb.Put(Op::End);
+
+			wbCode.PutU(wb.m_Res.size());
+			wbCode.Put(wb.m_Res);
+		}
+
+		WasmBuilder wbRes;
+		static const uint8_t pHdr[] = { 0, 'a', 's', 'm', 1, 0, 0, 0 };
+		wbRes.Put(Blob(pHdr, sizeof(pHdr)));
+
+		wbRes.Section(1, wbTypes);
+		wbRes.Section(2, wbImports);
+		wbRes.Section(3, wbFuncs);
+		wbRes.Section(6, wbGlobals);
+		wbRes.Section(7, wbExports);
+		wbRes.Section(10, wbCode);
+
+		res.swap(wbRes.m_Res);
+	}
+
+	void CostBench::Deploy()
+	{
+		ByteBuffer bufWasm, bufCode;
+		BuildModule(bufWasm);
+		Compile(bufCode, bufWasm, Kind::Contract);
+
+		get_Cid(m_Cid, bufCode, Blob(nullptr, 0));
+		SaveVar(m_Cid, bufCode);
+	}
+
+	bool CostBench::RunCase(uint32_t iCase, Result& res)
+	{
+		InitStackPlus(0);
+		m_Charge = Limits::BlockCharge;
+
+		m_Stack.AliasAlloc(sizeof(m_Cid));
+		memcpy(m_Stack.get_AliasPtr(), m_Cid.m_pData, sizeof(m_Cid));
+
+		std::string sErr;
+
+		auto t0 = std::chrono::steady_clock::now();
+		try
+		{
+			CallFar(m_Cid, s_iMethod0 + iCase, m_Stack.get_AlasSp(), sizeof(m_Cid), 0);
+			while (!IsDone())
+				RunCharged();
+		}
+		catch (const std::exception& e)
+		{
+			sErr = e.what(); // normally the charge exhaustion
+		}
+		auto dt = std::chrono::steady_clock::now() - t0;
+
+		m_FarCalls.m_Stack.Clear();
+
+		res.m_Units = Limits::BlockCharge - m_Charge;
+		res.m_Ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(dt).count());
+
+		// the endless loop should consume (almost) all the charge. Otherwise it failed for another reason
+		if (m_Charge * 100ull < Limits::BlockCharge)
+			return true;
+
+		std::cout << "  " << s_pCases[iCase].m_szName << " failed: " << sErr << std::endl;
+		return false;
+	}
+
+	void CostBench::RunAll(uint32_t nRuns, double dOutlier)
+	{
+		Deploy();
+
+		std::vector<Result> vRes;
+		vRes.reserve(s_Cases);
+
+		for (uint32_t iCase = 0; iCase < s_Cases; iCase++)
+		{
+			Result res;
+			res.m_szName = s_pCases[iCase].m_szName;
+			res.m_Ns = 0;
+			res.m_Units = 0;
+
+			for (uint32_t iRun = 0; iRun < nRuns; iRun++)
+			{
+				Result r;
+				if (!RunCase(iCase, r))
+					break;
+
+				if (!iRun || (r.get_NsPerUnit() < res.get_NsPerUnit()))
+				{
+					res.m_Units = r.m_Units;
+					res.m_Ns = r.m_Ns;
+				}
+			}
+
+			if (res.m_Units)
+				vRes.push_back(res);
+		}
+
+		if (vRes.empty())
+			return;
+
+		std::vector<double> vSorted;
+		for (const auto& r : vRes)
+			vSorted.push_back(r.get_NsPerUnit());
+		std::sort(vSorted.begin(), vSorted.end());
+		double dMedian = vSorted[vSorted.size() / 2];
+
+		std::cout << std::left << std::setw(28) << "Case" << std::right << std::setw(14) << "Units" << std::setw(12) << "Block ms" << std::setw(12) << "ns/unit" << std::endl;
+
+		double dWorst_ms = 0;
+		for (const auto& r : vRes)
+		{
+			double dMs = r.m_Ns / 1e6 * Limits::BlockCharge / r.m_Units; // normalize to the full block charge
+			std::setmax(dWorst_ms, dMs);
+
+			double dNs = r.get_NsPerUnit();
+
+			std::cout << std::left << std::setw(28) << r.m_szName << std::right
+				<< std::setw(14) << r.m_Units
+				<< std::setw(12) << std::fixed << std::setprecision(1) << dMs
+				<< std::setw(12) << std::setprecision(3) << dNs;
+
+			if (dNs > dMedian * dOutlier)
+				std::cout << "  <-- underpriced";
+			else if (dNs * dOutlier < dMedian)
+				std::cout << "  <-- overpriced";
+
+			std::cout << std::endl;
+		}
+
+		std::cout << "Median ns/unit: " << std::setprecision(3) << dMedian << ", worst block: " << std::setprecision(1) << dWorst_ms << " ms" << std::endl;
+	}
+
+} // namespace beam::bvm2
+
+int main(int argc, char* argv[])
+{
+	using namespace beam;
+
+	// args: [runs per case] [outlier factor vs median]
+	uint32_t nRuns = (argc > 1) ? std::max(atoi(argv[1]), 1) : 3;
+	double dOutlier = (argc > 2) ? atof(argv[2]) : 2.;
+
+	Rules r;
+	r.SetForksFrom(0, 0);
+	r.UpdateChecksum();
+	Rules::Scope scopeRules(r);
+
+	try
+	{
+		bvm2::CostBench cb;
+		cb.RunAll(nRuns, dOutlier);
+	}
+	catch (const std::exception& e)
+	{
+		std::cout << "Error: " << e.what() << std::endl;
+		return -1;
+	}
+
+	return 0;
+}
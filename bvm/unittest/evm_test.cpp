@@ -1011,6 +1011,94 @@ namespace beam
 
 	}
 
+	void TestEvmLimbs()
+	{
+		typedef Evm::Processor::Limbs Limbs;
+		typedef Evm::Word Word;
+
+		for (uint32_t iCycle = 0; iCycle < 2000; iCycle++)
+		{
+			Word a, b;
+			ECC::GenRandom(a);
+			ECC::GenRandom(b);
+
+			// sparse values to hit the carry/borrow edge cases
+			if (1 & iCycle)
+				memset(a.m_pData, 0xff, iCycle % Word::nBytes);
+			if (2 & iCycle)
+				memset0(b.m_pData, iCycle % Word::nBytes);
+
+			Limbs x, y, z;
+			x.Import(a);
+			y.Import(b);
+
+			Word w0, w1;
+			z.Export(w0); // garbage, just make sure no crash
+			x.Export(w0);
+			verify_test(w0 == a);
+
+			// add
+			w0 = b;
+			w0 += a;
+			z = y;
+			z.Add(x);
+			z.Export(w1);
+			verify_test(w0 == w1);
+
+			// sub
+			w0 = b;
+			w0.Negate();
+			w0 += a;
+			z = x;
+			z.Sub(y);
+			z.Export(w1);
+			verify_test(w0 == w1);
+
+			// mul
+			{
+				Word::Number n;
+				n.get_Slice().SetMul(a.ToNumber().get_ConstSlice(), b.ToNumber().get_ConstSlice());
+				w0.FromNumber(n);
+			}
+			z.SetMul(x, y);
+			z.Export(w1);
+			verify_test(w0 == w1);
+
+			// power, with a moderate exponent
+			{
+				Word e = Zero;
+				memcpy(e.m_pData + Word::nBytes - 2, b.m_pData, 2);
+				if (4 & iCycle)
+					e = b;
+
+				Word::Number n;
+				n.Power(a.ToNumber(), e.ToNumber());
+				w0.FromNumber(n);
+
+				Limbs le;
+				le.Import(e);
+				z.SetPower(x, le);
+				z.Export(w1);
+				verify_test(w0 == w1);
+			}
+
+			// shifts
+			uint32_t nShift = iCycle % Word::nBits;
+
+			a.ShiftLeft(nShift, w0);
+			z = x;
+			z.ShiftLeft(nShift);
+			z.Export(w1);
+			verify_test(w0 == w1);
+
+			a.ShiftRight(nShift, w0);
+			z = x;
+			z.ShiftRight(nShift);
+			z.Export(w1);
+			verify_test(w0 == w1);
+		}
+	}
+
 	void TestEvmTxKernel()
 	{
 		ECC::Scalar::Native skFrom, skBlind, skInp;
@@ -1070,6 +1158,7 @@ int main()
 
 		using namespace beam;
 
+		beam::TestEvmLimbs();
 		beam::TestEvmTxKernel();
 
 		beam::EvmTest1();
@@ -580,6 +580,60 @@ namespace bvm2 {
 		}
 	}
 
+	void TestCodeCache()
+	{
+		CodeCache& cc = CodeCache::get();
+
+		ContractID cid1, cid2;
+		ECC::GenRandom(cid1);
+		ECC::GenRandom(cid2);
+
+		ByteBuffer buf(1000);
+		ECC::GenRandom(&buf.front(), (uint32_t) buf.size());
+
+		auto p1 = cc.Get(cid1, buf);
+		verify_test(p1->m_Body == buf);
+		verify_test(cc.Get(cid1, buf) == p1); // shared, no copy
+
+		ShaderID sid;
+		get_ShaderID(sid, buf);
+		verify_test(p1->m_Sid == sid);
+
+		auto p2 = cc.Get(cid2, buf);
+		verify_test(p2 != p1); // different contract
+
+		buf[7] ^= 1; // code upgraded
+		auto p3 = cc.Get(cid1, buf);
+		verify_test(p3 != p1);
+		verify_test(p3->m_Body == buf);
+		verify_test(p1->m_Body != buf); // old image is still alive and intact
+
+		cc.Invalidate(cid1);
+		verify_test(cc.Get(cid1, buf) != p3);
+
+		// stamped code
+		uint64_t nStamp1 = CodeCache::get_NewStamp();
+		uint64_t nStamp2 = CodeCache::get_NewStamp();
+		verify_test(nStamp1 && (nStamp1 != nStamp2));
+
+		auto p4 = cc.Get(cid1, buf, nStamp1);
+		verify_test(cc.Get(cid1, buf, nStamp2) == p4); // stamp changed, same code. Validated by contents, the new stamp is adopted
+
+		ByteBuffer buf2 = buf;
+		buf2[9] ^= 1;
+		verify_test(cc.Get(cid1, buf2, nStamp2) == p4); // stamp match, the contents are not compared
+		verify_test(p4->m_Body == buf);
+
+		auto p5 = cc.Get(cid1, buf2, CodeCache::get_NewStamp());
+		verify_test(p5 != p4);
+		verify_test(p5->m_Body == buf2);
+
+		cc.set_BytesMax(1000);
+		verify_test(cc.get_Bytes() <= 1000);
+		verify_test(cc.Get(cid2, buf) != cc.Get(cid2, buf)); // too big for this budget, not retained
+		cc.set_BytesMax(0x2000000);
+	}
+
 	struct MyProcessor
 		:public ContractTestProcessor
 	{
@@ -1002,6 +1056,21 @@ namespace bvm2 {
 
 			verify_test(HeapAllocEx(p1, 37443));
 			HeapFreeEx(p1);
+
+			// freed neighbours must coalesce, regardless of the order
+			verify_test(HeapAllocEx(p1, 64));
+			verify_test(HeapAllocEx(p2, 64));
+			verify_test(HeapAllocEx(p3, 64));
+			verify_test((p2 == p1 + 64) && (p3 == p2 + 64));
+
+			HeapFreeEx(p2);
+			HeapFreeEx(p1);
+			HeapFreeEx(p3);
+
+			uint32_t p4;
+			verify_test(HeapAllocEx(p4, 192));
+			verify_test(p4 == p1);
+			HeapFreeEx(p4);
 		}
 
 		void RunMany(uint32_t iMethod)
@@ -4773,6 +4842,7 @@ int main()
 		using namespace beam::bvm2;
 
 		TestMergeSort();
+		TestCodeCache();
 		TestRLP();
 		TestEthSeedForPoW();
 
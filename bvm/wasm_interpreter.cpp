@@ -1787,7 +1787,41 @@ namespace Wasm {
 			return MemArgEx(nSize, false);
 		}
 
-		void RunOncePlus()
+#if defined(__GNUC__) && !defined(WASM_INTERPRETER_NO_THREADED)
+#	define WASM_INTERPRETER_THREADED // dispatch via computed goto (labels as values)
+#endif // __GNUC__
+
+#ifdef WASM_INTERPRETER_THREADED
+		// maps an opcode onto the handler index, in the order of the handler labels. 0 is reserved for invalid opcodes
+		struct DispatchIdx
+		{
+			uint8_t m_p[0x100];
+
+			constexpr DispatchIdx()
+				:m_p()
+			{
+				uint8_t i = 0;
+
+#define THE_MACRO(id, name) m_p[id] = ++i;
+				WasmInstructions_CustomPorted(THE_MACRO)
+				WasmInstructions_Proprietary(THE_MACRO)
+#undef THE_MACRO
+
+#define THE_MACRO(name, id32, id64) m_p[id32] = ++i; m_p[id64] = ++i;
+				WasmInstructions_unop_Polymorphic_32(THE_MACRO)
+				WasmInstructions_binop_Polymorphic_32(THE_MACRO)
+				WasmInstructions_binop_Polymorphic_x(THE_MACRO)
+#undef THE_MACRO
+
+#define THE_MACRO(id, type, name, tmem) m_p[id] = ++i;
+				WasmInstructions_Load(THE_MACRO)
+				WasmInstructions_Store(THE_MACRO)
+#undef THE_MACRO
+			}
+		};
+#endif // WASM_INTERPRETER_THREADED
+
+		void RunBatchPlus(uint32_t& nCharge, uint32_t nCost)
 		{
 			struct MyCheckpoint :public Exc::Checkpoint {
 				Word m_Ip;
@@ -1795,40 +1829,94 @@ namespace Wasm {
 					os << "wasm/Run, Ip=" << uintBigFrom(m_Ip);
 				}
 			} cp;
-			cp.m_Ip = get_Ip();
 
-			typedef Instruction I;
-			I nInstruction = (I) m_Instruction.Read1();
+			m_RunStop = false;
 
 #ifdef WASM_INTERPRETER_DEBUG
-			if (m_Dbg.m_Instructions)
+
+#	define WASM_LOG_IP \
+			if (m_Dbg.m_Instructions) \
 				*m_Dbg.m_pOut << "ip=" << uintBigFrom(cp.m_Ip) << ", sp=" << uintBigFrom(m_Stack.m_Pos) << ' ';
 
 #	define WASM_LOG_INSTRUCTION(name) if (m_Dbg.m_Instructions) (*m_Dbg.m_pOut) << #name << std::endl;
 #else // WASM_INTERPRETER_DEBUG
+#	define WASM_LOG_IP
 #	define WASM_LOG_INSTRUCTION(name)
 #endif // WASM_INTERPRETER_DEBUG
 
-			switch (nInstruction)
+#define WASM_FETCH \
+			if (m_RunStop || (nCharge < nCost)) \
+				return; \
+			nCharge -= nCost; \
+			cp.m_Ip = get_Ip(); \
+			WASM_LOG_IP
+
+#ifdef WASM_INTERPRETER_THREADED
+
+			static constexpr DispatchIdx s_Idx;
+
+			static const void* const s_pLabel[] = {
+				&&L_invalid,
+
+#define THE_MACRO(id, name) &&L_##name,
+				WasmInstructions_CustomPorted(THE_MACRO)
+				WasmInstructions_Proprietary(THE_MACRO)
+#undef THE_MACRO
+
+#define THE_MACRO(name, id32, id64) &&L_i32_##name, &&L_i64_##name,
+				WasmInstructions_unop_Polymorphic_32(THE_MACRO)
+				WasmInstructions_binop_Polymorphic_32(THE_MACRO)
+				WasmInstructions_binop_Polymorphic_x(THE_MACRO)
+#undef THE_MACRO
+
+#define THE_MACRO(id, type, name, tmem) &&L_##type##_##name,
+				WasmInstructions_Load(THE_MACRO)
+				WasmInstructions_Store(THE_MACRO)
+#undef THE_MACRO
+			};
+
+			// each handler dispatches the next instruction by itself
+#	define THE_NEXT \
+			WASM_FETCH \
+			goto *s_pLabel[s_Idx.m_p[m_Instruction.Read1()]];
+
+#	define THE_CASE(name) L_##name: WASM_LOG_INSTRUCTION(name)
+#	define THE_INVALID L_invalid:
+
+			THE_NEXT
+			{
+#else // WASM_INTERPRETER_THREADED
+
+#	define THE_NEXT break;
+#	define THE_CASE(name) case I::name: WASM_LOG_INSTRUCTION(name)
+#	define THE_INVALID default:
+
+			typedef Instruction I;
+
+			while (true)
 			{
-#define THE_CASE(name) case I::name: WASM_LOG_INSTRUCTION(name)
+				WASM_FETCH
+
+				switch ((I) m_Instruction.Read1())
+				{
+#endif // WASM_INTERPRETER_THREADED
 
-#define THE_MACRO(id, name) THE_CASE(name) On_##name(); break;
+#define THE_MACRO(id, name) THE_CASE(name) On_##name(); THE_NEXT
 			WasmInstructions_CustomPorted(THE_MACRO)
 			WasmInstructions_Proprietary(THE_MACRO)
 #undef THE_MACRO
 
 #define THE_MACRO(name, id32, id64) \
-			THE_CASE(i32_##name) On_##name<uint32_t, uint32_t>(); break; \
-			THE_CASE(i64_##name) On_##name<uint32_t, uint64_t>(); break;
+			THE_CASE(i32_##name) On_##name<uint32_t, uint32_t>(); THE_NEXT \
+			THE_CASE(i64_##name) On_##name<uint32_t, uint64_t>(); THE_NEXT
 
 			WasmInstructions_unop_Polymorphic_32(THE_MACRO)
 			WasmInstructions_binop_Polymorphic_32(THE_MACRO)
 #undef THE_MACRO
 
 #define THE_MACRO(name, id32, id64) \
-			THE_CASE(i32_##name) On_##name<uint32_t, uint32_t>(); break; \
-			THE_CASE(i64_##name) On_##name<uint64_t, uint64_t>(); break;
+			THE_CASE(i32_##name) On_##name<uint32_t, uint32_t>(); THE_NEXT \
+			THE_CASE(i64_##name) On_##name<uint64_t, uint64_t>(); THE_NEXT
 
 			WasmInstructions_binop_Polymorphic_x(THE_MACRO)
 #undef THE_MACRO
@@ -1839,7 +1927,7 @@ namespace Wasm {
 				tmem val1 = from_wasm<Type::ToFlexible<tmem, false>::T>(MemArgR(sizeof(tmem))); \
 				auto valExt = Type::Extend<Type::Code2Type<Type::type>::T, tmem>(val1); \
 				m_Stack.Push(valExt); \
-			} break;
+			} THE_NEXT
 
 			WasmInstructions_Load(THE_MACRO)
 #undef THE_MACRO
@@ -1848,15 +1936,25 @@ namespace Wasm {
 			THE_CASE(type##_##name) { \
 				auto val = m_Stack.Pop<Type::Code2Type<Type::type>::T>(); \
 				to_wasm(MemArgW(sizeof(tmem)), static_cast<tmem>(val)); \
-			} break;
+			} THE_NEXT
 
 			WasmInstructions_Store(THE_MACRO)
 #undef THE_MACRO
 
-			default:
+			THE_INVALID
 				Exc::Fail();
+
+#ifndef WASM_INTERPRETER_THREADED
+				}
+#endif // WASM_INTERPRETER_THREADED
 			}
 
+#undef THE_INVALID
+#undef THE_CASE
+#undef THE_NEXT
+#undef WASM_FETCH
+#undef WASM_LOG_INSTRUCTION
+#undef WASM_LOG_IP
 		}
 	};
 
@@ -1924,9 +2022,16 @@ namespace Wasm {
 
 	void Processor::RunOnce()
 	{
+		uint32_t nCharge = 1;
+		RunBatch(nCharge, 1);
+	}
+
+	void Processor::RunBatch(uint32_t& nCharge, uint32_t nCost)
+	{
+		assert(nCost);
 		auto& p = Cast::Up<ProcessorPlus>(*this);
 		static_assert(sizeof(p) == sizeof(*this));
-		p.RunOncePlus();
+		p.RunBatchPlus(nCharge, nCost);
 	}
 
 	void Processor::InvokeExt(uint32_t)
@@ -397,6 +397,10 @@ namespace Wasm {
 
 		void RunOnce();
 
+		// Runs instructions while nCharge covers nCost per instruction, or until m_RunStop is raised (by the handlers)
+		void RunBatch(uint32_t& nCharge, uint32_t nCost);
+		bool m_RunStop = false;
+
 		uint8_t* get_AddrEx(uint32_t nOffset, uint32_t nSize, bool bW) const;
 		uint8_t* get_AddrExVar(uint32_t nOffset, uint32_t& nSizeOut, bool bW) const;
 
@@ -21,6 +21,10 @@
 #	include <sys/mman.h>
 #	include <sys/types.h>
 #	include <unistd.h>
+#	ifdef __linux__
+#		include <sys/ioctl.h>
+#		include <linux/fs.h>
+#	endif // __linux__
 #endif // WIN32
 
 namespace beam
@@ -182,6 +186,81 @@ namespace beam
 		OpenMapping();
 	}
 
+	void MappedFileRaw::Flush()
+	{
+		if (!m_pMapping)
+			return;
+
+#ifdef WIN32
+		test_SysRet(!FlushViewOfFile(m_pMapping, 0), "FlushViewOfFile");
+		test_SysRet(!FlushFileBuffers(m_hFile), "FlushFileBuffers");
+#else // WIN32
+		test_SysRet(msync(m_pMapping, m_nMapping, MS_SYNC) != 0, "msync");
+#endif // WIN32
+	}
+
+	bool MappedFileRaw::Clone(const char* szDst, const char* szSrc, bool bAllowCopy /* = true */)
+	{
+#ifdef WIN32
+		if (!bAllowCopy)
+			return false;
+
+		test_SysRet(!CopyFileW(Utf8toUtf16(szSrc).c_str(), Utf8toUtf16(szDst).c_str(), FALSE), "CopyFile");
+#else // WIN32
+
+		struct Fd
+		{
+			int m_h;
+			~Fd() {
+				if (-1 != m_h)
+					close(m_h);
+			}
+		};
+
+		Fd fSrc, fDst;
+		fSrc.m_h = open(szSrc, O_RDONLY);
+		test_SysRet(-1 == fSrc.m_h, "open");
+
+		fDst.m_h = open(szDst, O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR | S_IRGRP);
+		test_SysRet(-1 == fDst.m_h, "open");
+
+#	ifdef FICLONE
+		if (!ioctl(fDst.m_h, FICLONE, fSrc.m_h))
+			return true; // only the extent map is copied
+#	endif // FICLONE
+
+		// not supported by the filesystem
+		if (!bAllowCopy)
+		{
+			close(fDst.m_h);
+			fDst.m_h = -1;
+			unlink(szDst);
+			return false;
+		}
+
+		// fallback to the plain copy
+		uint8_t pBuf[0x10000];
+		while (true)
+		{
+			ssize_t nRead = read(fSrc.m_h, pBuf, sizeof(pBuf));
+			test_SysRet(nRead < 0, "read");
+			if (!nRead)
+				break;
+
+			for (ssize_t nDone = 0; nDone < nRead; )
+			{
+				ssize_t nWritten = write(fDst.m_h, pBuf + nDone, nRead - nDone);
+				test_SysRet(nWritten <= 0, "write");
+				nDone += nWritten;
+			}
+		}
+
+		test_SysRet(fsync(fDst.m_h) != 0, "fsync");
+#endif // WIN32
+
+		return true;
+	}
+
 	MappedFileRaw::Offset MappedFileRaw::get_Offset(const void* p) const
 	{
 		Offset x = ((const uint8_t*) p) - m_pMapping;
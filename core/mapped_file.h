@@ -44,6 +44,11 @@ namespace beam
 
 		void Open(const char* sz);
 		void Close();
+		void Flush(); // write modified pages to the file
+
+		// copy the file contents. Uses a copy-on-write clone (reflink) where the filesystem supports it.
+		// Otherwise makes a full copy if allowed, or returns false (the dst is removed)
+		static bool Clone(const char* szDst, const char* szSrc, bool bAllowCopy = true);
 
 		template <typename T> T& get_At(Offset n) const
 		{
@@ -93,6 +98,7 @@ namespace beam
 
 		void Open(const char* sz, const Defs&, bool bReset = false);
 		void Close();
+		void Flush() { m_Raw.Flush(); }
 
 		void* get_FixedHdr() const;
 
@@ -17,6 +17,8 @@
 #include "core/ecc_native.h"
 #include "proto.h"
 #include "../utility/logger.h"
+#include "../utility/thread.h"
+#include <chrono>
 
 namespace beam {
 namespace proto {
@@ -272,6 +274,201 @@ bool Bbs::IsHashValid(const ECC::Hash::Value& hv)
 	return nHigh < (1 << 10); // upper 22 bits should be zero, probability ~ 1 / 4mln
 }
 
+/////////////////////////
+// CompactRelay
+uint64_t CompactRelay::get_ShortID(const Input& v, uint64_t nSalt)
+{
+	Recon::Key key;
+	ECC::Hash::Processor()
+		<< "cb.in"
+		<< v.m_Commitment
+		>> key;
+
+	return Recon::get_ShortID(key, nSalt) | 1;
+}
+
+uint64_t CompactRelay::get_ShortID(const Output& v, uint64_t nSalt)
+{
+	Recon::Key key;
+	ECC::Hash::Processor()
+		<< "cb.out"
+		<< v.m_Commitment
+		>> key;
+
+	return Recon::get_ShortID(key, nSalt) | 1;
+}
+
+uint64_t CompactRelay::get_ShortID(const TxKernel& v, uint64_t nSalt)
+{
+	return Recon::get_ShortID(v.get_ID(), nSalt) | 1;
+}
+
+void CompactRelay::get_Hash(ECC::Hash::Value& hv, const ByteBuffer& buf)
+{
+	ECC::Hash::Processor()
+		<< "cb.body"
+		<< Blob(buf)
+		>> hv;
+}
+
+/////////////////////////
+// Recon
+uint64_t Recon::get_ShortID(const Key& key, uint64_t nSalt)
+{
+	ECC::Hash::Value hv;
+	ECC::Hash::Processor()
+		<< "recon.id"
+		<< nSalt
+		<< key
+		>> hv;
+
+	uint64_t ret;
+	hv.ExportWord<0>(ret);
+	return ret;
+}
+
+namespace
+{
+	uint64_t ReconMix(uint64_t x, uint64_t nSeed)
+	{
+		// splitmix64 finalizer
+		x += nSeed * 0x9e3779b97f4a7c15ULL;
+		x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+		x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+		return x ^ (x >> 31);
+	}
+}
+
+uint32_t Recon::Sketch::get_Idx(uint64_t id, uint32_t iHash) const
+{
+	// partitioned: each hash addresses its own sub-table, so that an element never collides with itself
+	uint32_t nSub = get_Cells() / s_Hashes;
+	return iHash * nSub + static_cast<uint32_t>(ReconMix(id, iHash + 1) % nSub);
+}
+
+uint32_t Recon::Sketch::get_Check(uint64_t id)
+{
+	return static_cast<uint32_t>(ReconMix(id, s_Hashes + 1));
+}
+
+uint32_t Recon::Sketch::get_CellsFor(uint32_t nDiff)
+{
+	// 1.23 is the asymptotic threshold for 3 hashes, small tables need more slack. Rare failures are handled by the caller
+	return (nDiff << 1) + s_CellsMin;
+}
+
+void Recon::Sketch::Init(uint32_t nCells)
+{
+	std::setmax(nCells, s_CellsMin);
+	std::setmin(nCells, s_CellsMax);
+	nCells -= nCells % s_Hashes;
+
+	m_vCells.resize(nCells);
+	for (auto& c : m_vCells)
+		ZeroObject(c);
+}
+
+void Recon::Sketch::Add(uint64_t id, int32_t n)
+{
+	uint32_t nCheck = get_Check(id);
+
+	for (uint32_t i = 0; i < s_Hashes; i++)
+	{
+		Cell& c = m_vCells[get_Idx(id, i)];
+		c.m_Count += n;
+		c.m_IDs ^= id;
+		c.m_Check ^= nCheck;
+	}
+}
+
+void Recon::Sketch::Subtract(const Sketch& x)
+{
+	assert(get_Cells() == x.get_Cells());
+
+	for (size_t i = 0; i < m_vCells.size(); i++)
+	{
+		Cell& c = m_vCells[i];
+		const Cell& c2 = x.m_vCells[i];
+
+		c.m_Count -= c2.m_Count;
+		c.m_IDs ^= c2.m_IDs;
+		c.m_Check ^= c2.m_Check;
+	}
+}
+
+bool Recon::Sketch::Decode(std::vector<uint64_t>& vPlus, std::vector<uint64_t>& vMinus)
+{
+	// can't decode more elements than cells. Also protects against false-pure cells
+	uint32_t nRemaining = get_Cells();
+
+	for (bool bProgress = true; bProgress; )
+	{
+		bProgress = false;
+
+		for (const auto& c : m_vCells)
+		{
+			if (((1 != c.m_Count) && (-1 != c.m_Count)) || (get_Check(c.m_IDs) != c.m_Check))
+				continue; // not pure
+
+			if (!nRemaining--)
+				return false;
+
+			uint64_t id = c.m_IDs;
+			int32_t n = c.m_Count;
+
+			((n > 0) ? vPlus : vMinus).push_back(id);
+			Add(id, -n);
+
+			bProgress = true;
+		}
+	}
+
+	for (const auto& c : m_vCells)
+		if (c.m_Count || c.m_IDs || c.m_Check)
+			return false;
+
+	return true;
+}
+
+void Recon::Sketch::Write(ByteBuffer& buf) const
+{
+	buf.resize(m_vCells.size() * s_CellSize);
+	uint8_t* p = buf.empty() ? nullptr : &buf.front();
+
+	for (const auto& c : m_vCells)
+	{
+		reinterpret_cast<uintBigFor<uint32_t>::Type*>(p)->operator = (static_cast<uint32_t>(c.m_Count));
+		reinterpret_cast<uintBigFor<uint64_t>::Type*>(p + 4)->operator = (c.m_IDs);
+		reinterpret_cast<uintBigFor<uint32_t>::Type*>(p + 12)->operator = (c.m_Check);
+		p += s_CellSize;
+	}
+}
+
+bool Recon::Sketch::Read(const ByteBuffer& buf)
+{
+	if (buf.size() % s_CellSize)
+		return false;
+
+	size_t nCells = buf.size() / s_CellSize;
+	if ((nCells < s_CellsMin) || (nCells > s_CellsMax) || (nCells % s_Hashes))
+		return false;
+
+	m_vCells.resize(nCells);
+	const uint8_t* p = &buf.front();
+
+	for (auto& c : m_vCells)
+	{
+		uint32_t nCount;
+		reinterpret_cast<const uintBigFor<uint32_t>::Type*>(p)->Export(nCount);
+		c.m_Count = static_cast<int32_t>(nCount);
+		reinterpret_cast<const uintBigFor<uint64_t>::Type*>(p + 4)->Export(c.m_IDs);
+		reinterpret_cast<const uintBigFor<uint32_t>::Type*>(p + 12)->Export(c.m_Check);
+		p += s_CellSize;
+	}
+
+	return true;
+}
+
 union HighestMsgCode
 {
 #define THE_MACRO(code, msg) uint8_t m_pBuf_##msg[code + 1];
@@ -333,6 +530,241 @@ void ContractLogsReader::ReadOnceStrict()
 }
 
 
+/////////////////////////
+// DecoderLink
+struct DecoderLink
+    :public IErrorHandler
+    ,public std::enable_shared_from_this<DecoderLink>
+{
+    struct IMsg
+    {
+        typedef std::unique_ptr<IMsg> Ptr;
+        virtual ~IMsg() {}
+        virtual bool Dispatch(NodeConnection&) = 0; // returns false if the rest should not be dispatched
+    };
+
+    template <typename TMsg>
+    struct Msg :public IMsg
+    {
+        TMsg m_Msg;
+        uint32_t m_Size;
+        uint8_t m_Code;
+        uint64_t m_Decode_us = 0;
+        uint64_t m_Decoded_us = 0; // when, 0 if not measured
+
+        Msg(TMsg&& msg, uint32_t nSize, uint8_t nCode) :m_Msg(std::move(msg)), m_Size(nSize), m_Code(nCode) {}
+
+        bool Dispatch(NodeConnection& c) override
+        {
+            if (c.m_pTraficStats && m_Decoded_us)
+            {
+                TraficStats::PerType& x = c.m_pTraficStats->m_pType[m_Code];
+                x.m_Decode.Add(m_Decode_us);
+                x.m_Queue.Add(TraficStats::get_Time_us() - m_Decoded_us);
+            }
+
+            return c.OnMsgInternal(0, std::move(m_Msg), m_Size);
+        }
+    };
+
+    struct Error :public IMsg
+    {
+        bool m_Io;
+        int m_Code;
+
+        bool Dispatch(NodeConnection& c) override
+        {
+            if (m_Io)
+                c.on_connection_error(0, static_cast<io::ErrorCode>(m_Code));
+            else
+                c.on_protocol_error(0, static_cast<ProtocolError>(m_Code));
+            return false;
+        }
+    };
+
+    struct Chunk
+    {
+        ByteBuffer m_Data;
+        io::ErrorCode m_Err;
+    };
+
+    typedef std::pair<std::shared_ptr<DecoderLink>, IMsg::Ptr> Item;
+
+    std::shared_ptr<DecoderPool::Shard> m_pShard;
+
+    // reactor thread only
+    NodeConnection* m_pConn;
+
+    // protected by the shard mutex
+    std::vector<Chunk> m_vIn;
+    size_t m_InSize = 0;
+    bool m_Queued = false; // in the shard queue, or being decoded
+    bool m_Closed = false;
+
+    // decoder thread only
+    ProtocolPlus m_Protocol;
+    MsgReader m_Reader;
+    bool m_Failed = false;
+    std::vector<Item>* m_pOut = nullptr;
+    const bool m_Timing; // measure the decoding
+    uint64_t m_Last_us = 0;
+
+    static MsgHeader get_Hdr(NodeConnection& c) { return c.m_Protocol.get_default_header(); }
+
+    DecoderLink(const std::shared_ptr<DecoderPool::Shard>&, NodeConnection&);
+
+    bool Post(io::ErrorCode, const void*, size_t); // returns false if too much is pending
+    void Detach();
+    void Decode(std::vector<Chunk>&, std::vector<Item>&);
+
+    void PushError(bool bIo, int nCode);
+    void OnMsgTiming(uint64_t& dt_us, uint64_t& t_us);
+
+    // IErrorHandler
+    void on_protocol_error(uint64_t, ProtocolError err) override { PushError(false, static_cast<int>(err)); }
+    void on_connection_error(uint64_t, io::ErrorCode err) override { PushError(true, err); }
+
+    // track the inbound cipher, same as NodeConnection does
+    template <typename TMsg>
+    void OnCtl(const TMsg&) {}
+
+    void OnCtl(const SChannelInitiate_NoInit& msg)
+    {
+        if ((ProtocolPlus::Mode::Plaintext == m_Protocol.m_Mode) && !(msg.m_NoncePub == Zero) &&
+            InitViaDiffieHellman(m_Protocol.m_MyNonce, msg.m_NoncePub, m_Protocol.m_Enc, m_Protocol.m_HMac, nullptr, &m_Protocol.m_CipherIn))
+            m_Protocol.m_Mode = ProtocolPlus::Mode::Outgoing;
+    }
+
+    void OnCtl(const SChannelReady_NoInit&)
+    {
+        if (ProtocolPlus::Mode::Outgoing == m_Protocol.m_Mode)
+            m_Protocol.m_Mode = ProtocolPlus::Mode::Duplex;
+    }
+
+#define THE_MACRO(code, msg) \
+    bool OnMsgDecoded(uint64_t, msg##_NoInit&& v, uint32_t nSize) \
+    { \
+        OnCtl(v); \
+        auto pMsg = std::make_unique<Msg<msg##_NoInit> >(std::move(v), nSize, uint8_t(code)); \
+        if (m_Timing) \
+            OnMsgTiming(pMsg->m_Decode_us, pMsg->m_Decoded_us); \
+        m_pOut->emplace_back(shared_from_this(), std::move(pMsg)); \
+        return true; \
+    }
+
+    BeamNodeMsgsAll(THE_MACRO)
+#undef THE_MACRO
+};
+
+struct DecoderPool::Shard
+{
+    std::mutex m_Mutex;
+    std::condition_variable m_NewTask;
+    bool m_Run = true;
+
+    std::deque<std::shared_ptr<DecoderLink> > m_queReady;
+    std::vector<DecoderLink::Item> m_vDone;
+
+    io::AsyncEvent::Ptr m_pEvtDone;
+    MyThread m_Thread;
+
+    void RunThread(const Rules&);
+    void OnDone();
+};
+
+DecoderLink::DecoderLink(const std::shared_ptr<DecoderPool::Shard>& pShard, NodeConnection& c)
+    :m_pShard(pShard)
+    ,m_pConn(&c)
+    ,m_Protocol(get_Hdr(c).V0, get_Hdr(c).V1, get_Hdr(c).V2, c.m_Protocol.max_message_types(), *this, 20000)
+    ,m_Reader(m_Protocol, 0, 100)
+    ,m_Timing(c.m_pTraficStats != nullptr)
+{
+#define THE_MACRO(code, msg) \
+    m_Protocol.add_message_handler<DecoderLink, msg##_NoInit, &DecoderLink::OnMsgDecoded>(uint8_t(code), this, 0, 1024*1024*10);
+
+    BeamNodeMsgsAll(THE_MACRO)
+#undef THE_MACRO
+
+    m_Protocol.m_MyNonce = c.m_Protocol.m_MyNonce;
+}
+
+bool DecoderLink::Post(io::ErrorCode err, const void* p, size_t n)
+{
+    Chunk c;
+    c.m_Err = err;
+    if (n)
+        c.m_Data.assign(static_cast<const uint8_t*>(p), static_cast<const uint8_t*>(p) + n);
+
+    DecoderPool::Shard& s = *m_pShard;
+    std::unique_lock<std::mutex> scope(s.m_Mutex);
+
+    if (m_Closed || !s.m_Run)
+        return true;
+
+    if (m_InSize + n > DecoderPool::s_PendingMax)
+        return false;
+
+    m_vIn.push_back(std::move(c));
+    m_InSize += n;
+
+    if (!m_Queued)
+    {
+        m_Queued = true;
+        s.m_queReady.push_back(shared_from_this());
+        s.m_NewTask.notify_one();
+    }
+
+    return true;
+}
+
+void DecoderLink::Detach()
+{
+    m_pConn = nullptr;
+
+    std::unique_lock<std::mutex> scope(m_pShard->m_Mutex);
+    m_Closed = true;
+    m_vIn.clear();
+    m_InSize = 0;
+}
+
+void DecoderLink::Decode(std::vector<Chunk>& vIn, std::vector<Item>& vOut)
+{
+    m_pOut = &vOut;
+
+    for (auto& c : vIn)
+    {
+        if (m_Failed)
+            break;
+
+        if (m_Timing)
+            m_Last_us = TraficStats::get_Time_us();
+
+        // the chunk is ours, decrypted in-place
+        m_Reader.new_data_from_stream(c.m_Err, c.m_Data.data(), c.m_Data.size());
+    }
+
+    m_pOut = nullptr;
+}
+
+void DecoderLink::OnMsgTiming(uint64_t& dt_us, uint64_t& t_us)
+{
+    // since the previous message, or the chunk start. Partial messages from the previous chunks aren't accounted
+    t_us = TraficStats::get_Time_us();
+    dt_us = t_us - m_Last_us;
+    m_Last_us = t_us;
+}
+
+void DecoderLink::PushError(bool bIo, int nCode)
+{
+    m_Failed = true;
+
+    auto pErr = std::make_unique<Error>();
+    pErr->m_Io = bIo;
+    pErr->m_Code = nCode;
+
+    m_pOut->emplace_back(shared_from_this(), std::move(pErr));
+}
+
 /////////////////////////
 // NodeConnection
 NodeConnection::NodeConnection()
@@ -362,6 +794,17 @@ void NodeConnection::Reset()
     }
 
 	m_RulesCfgSent = false;
+
+    if (m_pDecoderLink)
+    {
+        m_pDecoderLink->Detach();
+        m_pDecoderLink.reset();
+    }
+
+    m_FlushEvt.cancel();
+    if (m_Connection)
+        m_Connection->flush(); // the last messages (such as Bye) should be sent
+
     m_Connection = NULL;
     m_pAsyncFail = NULL;
     m_LoginFlags = 0;
@@ -388,20 +831,69 @@ void NodeConnection::TestIoResultAsync(const io::Result& res)
     m_pAsyncFail->get_trigger()();
 }
 
+void NodeConnection::ScheduleFlush()
+{
+    if (m_Connection->get_Unflushed() > s_UnflushedMax)
+        FlushOut();
+    else
+        m_FlushEvt.start();
+}
+
+void NodeConnection::FlushEvt::OnSchedule()
+{
+    get_ParentObj().FlushOut();
+}
+
+void NodeConnection::FlushOut()
+{
+    m_FlushEvt.cancel();
+
+    if (m_Connection && m_Connection->get_Unflushed())
+        TestIoResultAsync(m_Connection->flush());
+}
+
 void NodeConnection::TestNotDrown()
 {
-	if (!m_pAsyncFail && m_UnsentHiMark && (get_Unsent() > m_UnsentHiMark))
+	if (m_UnsentHiMark && (get_Unsent() > m_UnsentHiMark))
+		OnDrownAsync();
+}
+
+void NodeConnection::OnDrownAsync()
+{
+	if (m_pAsyncFail)
+		return;
+
+	io::AsyncEvent::Callback cb = [this]()
 	{
-		io::AsyncEvent::Callback cb = [this]()
-		{
-			DisconnectReason r;
-			r.m_Type = DisconnectReason::Drown;
-			OnDisconnect(r);
-		};
+		DisconnectReason r;
+		r.m_Type = DisconnectReason::Drown;
+		OnDisconnect(r);
+	};
 
-		m_pAsyncFail = io::AsyncEvent::create(io::Reactor::get_Current(), std::move(cb));
-		m_pAsyncFail->get_trigger()();
-	}
+	m_pAsyncFail = io::AsyncEvent::create(io::Reactor::get_Current(), std::move(cb));
+	m_pAsyncFail->get_trigger()();
+}
+
+void NodeConnection::MaybeOffloadDecoding()
+{
+    if (!m_pDecoderPool || !m_pDecoderPool->IsRunning() || m_pDecoderLink || !m_Connection)
+        return;
+
+    if (m_Connection->get_Received() || (ProtocolPlus::Mode::Plaintext != m_Protocol.m_Mode))
+        return; // too late, the inbound cipher can only be tracked from the very beginning
+
+    m_pDecoderLink = m_pDecoderPool->Attach(*this);
+    m_Connection->redirect_read([this](io::ErrorCode err, void* p, size_t n) { return OnDataOffloaded(err, p, n); });
+}
+
+bool NodeConnection::OnDataOffloaded(io::ErrorCode err, const void* p, size_t n)
+{
+    assert(m_pDecoderLink);
+
+    if (!m_pDecoderLink->Post(err, p, n))
+        OnDrownAsync(); // the peer sends faster than we can decode
+
+    return !err;
 }
 
 void NodeConnection::OnConnectInternal(uint64_t tag, io::TcpStream::Ptr&& newStream, io::ErrorCode status)
@@ -569,12 +1061,7 @@ void NodeConnection::SendRaw(const msg& v) \
     m_SerializeCache.clear(); \
     MsgSerializer& ser = m_Protocol.serializeNoFinalize(m_SerializeCache, uint8_t(code), v); \
     m_Protocol.Encrypt(m_SerializeCache, ser); \
-    OnTraficOut(msg::s_Code); \
-    io::Result res = m_Connection->write_msg(m_SerializeCache); \
-    m_SerializeCache.clear(); \
-\
-    TestIoResultAsync(res); \
-    TestNotDrown(); \
+    WriteSerialized(msg::s_Code); \
 } \
 \
 bool NodeConnection::OnMsgInternal(uint64_t, msg##_NoInit&& v, uint32_t msgSize) \
@@ -583,7 +1070,15 @@ bool NodeConnection::OnMsgInternal(uint64_t, msg##_NoInit&& v, uint32_t msgSize)
         /* checkpoint */ \
         TestInputMsgContext(code); \
         OnTrafic(msg::s_Code, msgSize, false); \
-        return OnMsg2(std::move(v)); \
+        TraficStats* pStats = m_pTraficStats; \
+        if (!pStats) \
+            return OnMsg2(std::move(v)); \
+        pStats->m_pType[code].m_In.Add(msgSize); \
+        uint64_t t_us = TraficStats::get_Time_us(); \
+        bool bRet = OnMsg2(std::move(v)); \
+        /* don't access this, might be deleted */ \
+        pStats->m_pType[code].m_Handle.Add(TraficStats::get_Time_us() - t_us); \
+        return bRet; \
     } catch (const NodeProcessingException& e) { \
         OnProcessingExc(e); \
         return false; \
@@ -596,15 +1091,79 @@ bool NodeConnection::OnMsgInternal(uint64_t, msg##_NoInit&& v, uint32_t msgSize)
 BeamNodeMsgsAll(THE_MACRO)
 #undef THE_MACRO
 
+void NodeConnection::Send(const Broadcast& msg)
+{
+    if (!IsLive())
+        return;
+
+    m_SerializeCache.clear();
+    MsgSerializer& ser = m_Protocol.serializeRawNoFinalize(m_SerializeCache, msg.m_Code, msg.m_Body.data(), msg.m_Body.size());
+    m_Protocol.Encrypt(m_SerializeCache, ser);
+    WriteSerialized(msg.m_Code);
+}
+
+void NodeConnection::WriteSerialized(uint8_t nCode)
+{
+    OnTraficOut(nCode);
+    io::Result res = m_Connection->write_msg(m_SerializeCache, false);
+    m_SerializeCache.clear();
+
+    if (res)
+        ScheduleFlush();
+    TestIoResultAsync(res);
+    TestNotDrown();
+}
+
 void NodeConnection::OnTraficOut(uint8_t nCode)
 {
     uint32_t msgSize = 0;
     for (const auto& buf : m_SerializeCache)
         msgSize += (uint32_t) buf.size;
     
+    if (m_pTraficStats)
+        m_pTraficStats->m_pType[nCode].m_Out.Add(msgSize);
+
     OnTrafic(nCode, msgSize, true);
 }
 
+/////////////////////////
+// TraficStats
+void TraficStats::Histogram::Add(uint64_t dt_us)
+{
+    uint32_t iBucket = 0;
+    for (uint64_t x = 10; (dt_us >= x) && (iBucket + 1 < s_Buckets); x *= 10)
+        iBucket++;
+
+    m_pCount[iBucket]++;
+    m_Total_us += dt_us;
+    std::setmax(m_Max_us, static_cast<uint32_t>(std::min<uint64_t>(dt_us, static_cast<uint32_t>(-1))));
+}
+
+uint64_t TraficStats::Histogram::get_Count() const
+{
+    uint64_t n = 0;
+    for (uint32_t i = 0; i < s_Buckets; i++)
+        n += m_pCount[i];
+    return n;
+}
+
+uint64_t TraficStats::get_Time_us()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+const char* TraficStats::get_MsgName(uint8_t nCode)
+{
+    switch (nCode)
+    {
+#define THE_MACRO(code, msg) case code: return #msg;
+        BeamNodeMsgsAll(THE_MACRO)
+#undef THE_MACRO
+    }
+
+    return nullptr;
+}
+
 
 void NodeConnection::TestInputMsgContext(uint8_t code)
 {
@@ -641,6 +1200,8 @@ void NodeConnection::SecureConnect()
     SChannelInitiate msg;
     msg.m_NoncePub.FromSk(m_Protocol.m_MyNonce);
     Send(msg);
+
+    MaybeOffloadDecoding();
 }
 
 void NodeConnection::OnMsg(SChannelInitiate&& msg)
@@ -1055,6 +1616,143 @@ void NodeConnection::Server::Listen(const io::Address& addr)
     m_pServer = io::TcpServer::create(io::Reactor::get_Current(), addr, BIND_THIS_MEMFN(OnAccepted));
 }
 
+/////////////////////////
+// DecoderPool
+DecoderPool::~DecoderPool()
+{
+    Stop();
+}
+
+void DecoderPool::Start(uint32_t nThreads)
+{
+    Stop();
+
+    m_vShards.resize(nThreads);
+    for (auto& pShard : m_vShards)
+    {
+        pShard = std::make_shared<Shard>();
+        Shard& s = *pShard;
+
+        s.m_pEvtDone = io::AsyncEvent::create(io::Reactor::get_Current(), [&s]() { s.OnDone(); });
+        s.m_Thread = MyThread(&Shard::RunThread, &s, Rules::get());
+    }
+}
+
+void DecoderPool::Stop()
+{
+    for (const auto& pShard : m_vShards)
+    {
+        Shard& s = *pShard;
+
+        {
+            std::unique_lock<std::mutex> scope(s.m_Mutex);
+            s.m_Run = false;
+            s.m_NewTask.notify_one();
+        }
+
+        if (s.m_Thread.joinable())
+            s.m_Thread.join();
+
+        // links reference the shard, break the cycle
+        s.m_queReady.clear();
+        s.m_vDone.clear();
+    }
+
+    m_vShards.clear();
+}
+
+std::shared_ptr<DecoderLink> DecoderPool::Attach(NodeConnection& c)
+{
+    assert(IsRunning());
+    const auto& pShard = m_vShards[m_iNext++ % m_vShards.size()];
+    return std::make_shared<DecoderLink>(pShard, c);
+}
+
+void DecoderPool::Shard::RunThread(const Rules& r)
+{
+    Rules::Scope scopeRules(r);
+
+    std::vector<DecoderLink::Chunk> vIn;
+    std::vector<DecoderLink::Item> vOut;
+
+    while (true)
+    {
+        std::shared_ptr<DecoderLink> pLink;
+
+        {
+            std::unique_lock<std::mutex> scope(m_Mutex);
+            while (true)
+            {
+                if (!m_Run)
+                    return;
+
+                if (m_queReady.empty())
+                {
+                    m_NewTask.wait(scope);
+                    continue;
+                }
+
+                pLink = std::move(m_queReady.front());
+                m_queReady.pop_front();
+
+                if (!pLink->m_Closed)
+                    break;
+
+                pLink->m_Queued = false;
+            }
+
+            vIn.swap(pLink->m_vIn);
+            pLink->m_InSize = 0;
+        }
+
+        pLink->Decode(vIn, vOut);
+        vIn.clear();
+
+        bool bNotify = false;
+
+        {
+            std::unique_lock<std::mutex> scope(m_Mutex);
+
+            if (pLink->m_vIn.empty() || pLink->m_Closed)
+                pLink->m_Queued = false;
+            else
+                m_queReady.push_back(std::move(pLink)); // more data arrived meanwhile
+
+            if (!vOut.empty())
+            {
+                bNotify = m_vDone.empty();
+                for (auto& x : vOut)
+                    m_vDone.push_back(std::move(x));
+            }
+        }
+
+        vOut.clear();
+
+        if (bNotify)
+            m_pEvtDone->post();
+    }
+}
+
+void DecoderPool::Shard::OnDone()
+{
+    std::vector<DecoderLink::Item> v;
+
+    {
+        std::unique_lock<std::mutex> scope(m_Mutex);
+        v.swap(m_vDone);
+    }
+
+    for (auto& x : v)
+    {
+        DecoderLink& l = *x.first;
+        if (!l.m_pConn)
+            continue; // detached
+
+        if (!x.second->Dispatch(*l.m_pConn) && l.m_pConn)
+            l.Detach(); // stop, as the MsgReader would
+    }
+}
+
 /////////////////////////
 // Event
 void Event::IParserBase::ProceedOnce(Deserializer& der)
@@ -203,6 +203,40 @@ namespace proto {
     macro(ByteBuffer, Message) \
     macro(Bbs::NonceType, Nonce)
 
+#define BeamNodeMsg_ReconSketch(macro) \
+    macro(uint8_t, Type) \
+    macro(uint64_t, Salt) \
+    macro(ByteBuffer, Cells)
+
+#define BeamNodeMsg_ReconRequest(macro) \
+    macro(uint8_t, Type) \
+    macro(uint64_t, Salt) \
+    macro(bool, All) \
+    macro(std::vector<uint64_t>, IDs)
+
+#define BeamNodeMsg_CompactBlock(macro) \
+    macro(Block::SystemState::Full, Description) \
+    macro(Block::BodyBase, Base) \
+    macro(uint64_t, Salt) \
+    macro(std::vector<uint64_t>, Inputs) \
+    macro(std::vector<uint64_t>, Outputs) \
+    macro(std::vector<uint64_t>, Kernels) \
+    macro(TxVectors::Perishable, PrefilledP) \
+    macro(TxVectors::Eternal, PrefilledE) \
+    macro(ECC::Hash::Value, HashP) \
+    macro(ECC::Hash::Value, HashE)
+
+#define BeamNodeMsg_GetCompactMissing(macro) \
+    macro(Block::SystemState::ID, ID) \
+    macro(std::vector<uint32_t>, Inputs) \
+    macro(std::vector<uint32_t>, Outputs) \
+    macro(std::vector<uint32_t>, Kernels)
+
+#define BeamNodeMsg_CompactMissing(macro) \
+    macro(Block::SystemState::ID, ID) \
+    macro(TxVectors::Perishable, Perishable) \
+    macro(TxVectors::Eternal, Eternal)
+
 #define BeamNodeMsg_BbsHaveMsg(macro) \
     macro(BbsMsgID, Key)
 
@@ -381,6 +415,9 @@ namespace proto {
     macro(0x2b, GetProofKernel3) \
     macro(0x26, GetBodyPack) \
     macro(0x27, BodyPack) \
+    macro(0x5a, CompactBlock) \
+    macro(0x5b, GetCompactMissing) \
+    macro(0x5c, CompactMissing) \
     macro(0x28, GetProofShieldedOutp) \
     macro(0x20, GetProofShieldedInp) \
     macro(0x35, GetProofAsset) \
@@ -409,6 +446,9 @@ namespace proto {
     macro(0x31, HaveTransaction) \
     macro(0x32, GetTransaction) \
     macro(0x49, NewTransaction) \
+    /* tx and bbs announcements reconciliation */ \
+    macro(0x58, ReconSketch) \
+    macro(0x59, ReconRequest) \
     /* dependent context and txs */ \
     macro(0x4a, SetDependentContext) \
     macro(0x4b, DependentContextChanged) \
@@ -470,7 +510,11 @@ namespace proto {
         };
 
         static const uint32_t WantDependentState     = 0x10000; // Please send me dependent state updates
+        static const uint32_t Reconciliation         = 0x20000; // Announce txs and bbs msgs to me via ReconSketch/ReconRequest
+        static const uint32_t CompactBlocks          = 0x40000; // Announce new blocks to me via CompactBlock (instead of NewTip)
         static_assert(!(WantDependentState  & Extension::Msk));
+        static_assert(!(Reconciliation  & Extension::Msk));
+        static_assert(!(CompactBlocks  & Extension::Msk));
 	};
 
     struct IDType
@@ -631,6 +675,9 @@ namespace proto {
     inline void ZeroInit(ECC::Signature& x) { ZeroObject(x); }
     inline void ZeroInit(TxKernel::LongProof& x) { ZeroObject(x.m_State); }
 	inline void ZeroInit(BodyBuffers&) { }
+    inline void ZeroInit(Block::BodyBase& x) { x.ZeroInit(); }
+    inline void ZeroInit(TxVectors::Perishable&) { }
+    inline void ZeroInit(TxVectors::Eternal&) { }
     inline void ZeroInit(Asset::Info& x) { x.Reset(); }
     inline void ZeroInit(Asset::Full& x) { x.Reset(); }
     inline void ZeroInit(HeightPos& x) { ZeroObject(x); }
@@ -740,6 +787,68 @@ namespace proto {
 		bool IsHashValid(const ECC::Hash::Value&);
 	}
 
+	// Set reconciliation of announcements (txs, bbs msgs) between the peers that both support it.
+	// Each side accumulates the keys it would announce to the peer. Periodically the initiator sends the sketch of its set,
+	// the responder decodes the symmetric difference, announces what the initiator lacks, and requests the rest by short IDs.
+	struct Recon
+	{
+		struct Type {
+			static const uint8_t Tx = 0;
+			static const uint8_t Bbs = 1;
+			static const uint8_t count = 2;
+		};
+
+		typedef ECC::Hash::Value Key;
+		static uint64_t get_ShortID(const Key&, uint64_t nSalt);
+
+		// Invertible bloom lookup table of short IDs
+		class Sketch
+		{
+			struct Cell {
+				int32_t m_Count;
+				uint64_t m_IDs; // xor
+				uint32_t m_Check; // xor
+			};
+
+			std::vector<Cell> m_vCells;
+
+			uint32_t get_Idx(uint64_t id, uint32_t iHash) const;
+			static uint32_t get_Check(uint64_t id);
+
+		public:
+			static const uint32_t s_Hashes = 3;
+			static const uint32_t s_CellsMin = s_Hashes * 8;
+			static const uint32_t s_CellsMax = s_Hashes * 1024;
+			static const uint32_t s_CellSize = 16; // serialized
+
+			static uint32_t get_CellsFor(uint32_t nDiff); // recommended size to decode the given difference
+
+			void Init(uint32_t nCells); // rounded and clamped
+			uint32_t get_Cells() const { return static_cast<uint32_t>(m_vCells.size()); }
+
+			void Add(uint64_t id, int32_t n = 1);
+			void Subtract(const Sketch&); // must be of the same size
+
+			// Destructive. On success vPlus contains IDs present only in this, vMinus - only in the subtracted
+			bool Decode(std::vector<uint64_t>& vPlus, std::vector<uint64_t>& vMinus);
+
+			void Write(ByteBuffer&) const;
+			bool Read(const ByteBuffer&);
+		};
+	};
+
+	// Compact block relay. A new block is announced by its header and salted short IDs of its elements (in the block order).
+	// Elements that the sender doesn't expect the receiver to have are prefilled, their short IDs are zero.
+	// The receiver reconstructs the body from its tx pool, requests the missing elements, and verifies the result by the hashes of the body buffers.
+	struct CompactRelay
+	{
+		static uint64_t get_ShortID(const Input&, uint64_t nSalt); // never zero
+		static uint64_t get_ShortID(const Output&, uint64_t nSalt);
+		static uint64_t get_ShortID(const TxKernel&, uint64_t nSalt);
+
+		static void get_Hash(ECC::Hash::Value&, const ByteBuffer&);
+	};
+
     struct ProtocolPlus
         :public Protocol
     {
@@ -812,9 +921,63 @@ namespace proto {
         Type m_type;
     };
 
+    class DecoderPool;
+    struct DecoderLink;
+
+    // Traffic and timing counters per message type. Updated on the reactor thread only
+    struct TraficStats
+    {
+        struct Histogram
+        {
+            static const uint32_t s_Buckets = 7; // decimal scale: <10us, <100us, ..., <1s, the rest
+
+            uint64_t m_pCount[s_Buckets];
+            uint64_t m_Total_us;
+            uint32_t m_Max_us;
+
+            void Add(uint64_t dt_us);
+            uint64_t get_Count() const;
+        };
+
+        struct Counter
+        {
+            uint64_t m_Msgs;
+            uint64_t m_Bytes;
+
+            void Add(uint32_t nSize) {
+                m_Msgs++;
+                m_Bytes += nSize;
+            }
+        };
+
+        struct Totals
+        {
+            Counter m_In;
+            Counter m_Out;
+        };
+
+        struct PerType
+            :public Totals
+        {
+            Histogram m_Handle;
+            Histogram m_Decode; // only if decoded on the DecoderPool
+            Histogram m_Queue; // delay between decoding and handling, same
+        };
+
+        PerType m_pType[0x100];
+
+        TraficStats() { Reset(); }
+        void Reset() { ZeroObject(m_pType); }
+
+        static uint64_t get_Time_us();
+        static const char* get_MsgName(uint8_t nCode); // or NULL if unknown
+    };
+
     class NodeConnection
         :public INodeMsgHandler
     {
+        friend struct DecoderLink;
+
         ProtocolPlus m_Protocol;
         std::unique_ptr<Connection> m_Connection;
         io::AsyncEvent::Ptr m_pAsyncFail;
@@ -823,6 +986,23 @@ namespace proto {
 
         SerializedMsg m_SerializeCache;
 
+        // Outgoing messages are accumulated and sent together, once per reactor iteration
+        struct FlushEvt
+            :public io::IdleEvt
+        {
+            void OnSchedule() override;
+            IMPLEMENT_GET_PARENT_OBJ(NodeConnection, m_FlushEvt)
+        } m_FlushEvt;
+
+        static const size_t s_UnflushedMax = 0x10000; // flushed immediately if exceeded
+        void ScheduleFlush();
+        void FlushOut();
+
+        std::shared_ptr<DecoderLink> m_pDecoderLink;
+        void MaybeOffloadDecoding();
+        bool OnDataOffloaded(io::ErrorCode, const void*, size_t);
+        void OnDrownAsync();
+
         void TestIoResultAsync(const io::Result& res);
         void TestInputMsgContext(uint8_t);
 
@@ -841,12 +1021,16 @@ namespace proto {
 		void OnLoginInternal(Login&&);
 
         void OnTraficOut(uint8_t);
+        void WriteSerialized(uint8_t nCode);
 
     public:
 
         uint32_t m_LoginFlags;
         uint32_t get_Ext() const;
 
+        DecoderPool* m_pDecoderPool = nullptr; // optional, decode the incoming traffic on its threads. Must be set before connecting
+        TraficStats* m_pTraficStats = nullptr; // optional, must outlive the connection. Must be set before connecting
+
         NodeConnection();
         virtual ~NodeConnection();
         void Reset();
@@ -955,6 +1139,25 @@ namespace proto {
 
         void Send(const NewTransaction&);
 
+        // Message serialized once, to be sent to many peers. Only the framing and encryption are done per connection
+        struct Broadcast
+        {
+            uint8_t m_Code = 0;
+            ByteBuffer m_Body;
+
+            template <typename TMsg>
+            void Set(const TMsg& msg)
+            {
+                m_Code = TMsg::s_Code;
+
+                Serializer ser;
+                ser & msg;
+                ser.swap_buf(m_Body);
+            }
+        };
+
+        void Send(const Broadcast&);
+
         struct Server
         {
             io::TcpServer::Ptr m_pServer; // just delete it to stop listening
@@ -968,5 +1171,29 @@ namespace proto {
 
     std::ostream& operator << (std::ostream& s, const NodeConnection::DisconnectReason&);
 
+    // Decodes the incoming traffic (decryption, MAC verification, framing, deserialization) of the attached connections on dedicated threads.
+    // Each connection is pinned to a single thread, so that its messages are handled in order. Decoded messages are dispatched on the reactor thread in batches.
+    class DecoderPool
+    {
+        friend class NodeConnection;
+        friend struct DecoderLink;
+
+        struct Shard;
+        std::vector<std::shared_ptr<Shard> > m_vShards;
+        uint32_t m_iNext = 0;
+
+        std::shared_ptr<DecoderLink> Attach(NodeConnection&);
+
+    public:
+
+        static const size_t s_PendingMax = 1024 * 1024 * 32; // per connection, received but not decoded yet
+
+        ~DecoderPool();
+
+        void Start(uint32_t nThreads); // must be called on the reactor thread
+        void Stop();
+        bool IsRunning() const { return !m_vShards.empty(); }
+    };
+
 } // namespace proto
 } // namespace beam
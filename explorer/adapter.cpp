@@ -2927,6 +2927,75 @@ private:
         return result;
     }
 
+    static json get_TraficJson(const proto::TraficStats::Totals& x)
+    {
+        return json{
+            {"in_msgs", x.m_In.m_Msgs},
+            {"in_bytes", x.m_In.m_Bytes},
+            {"out_msgs", x.m_Out.m_Msgs},
+            {"out_bytes", x.m_Out.m_Bytes},
+        };
+    }
+
+    static json get_TraficJson(const proto::TraficStats::Histogram& x)
+    {
+        json jHist = json::array();
+        for (uint32_t i = 0; i < proto::TraficStats::Histogram::s_Buckets; i++)
+            jHist.push_back(x.m_pCount[i]);
+
+        return json{
+            {"count", x.get_Count()},
+            {"total_us", x.m_Total_us},
+            {"max_us", x.m_Max_us},
+            {"hist_log10_us", std::move(jHist)},
+        };
+    }
+
+    json get_trafic() override
+    {
+        const auto& ts = _node.get_TraficStats();
+
+        json jTypes = json::array();
+        for (uint32_t i = 0; i < _countof(ts.m_pType); i++)
+        {
+            const auto& x = ts.m_pType[i];
+            if (!x.m_In.m_Msgs && !x.m_Out.m_Msgs)
+                continue;
+
+            json j = get_TraficJson(Cast::Down<proto::TraficStats::Totals>(x));
+            j["type"] = proto::TraficStats::get_MsgName(static_cast<uint8_t>(i));
+            j["handle"] = get_TraficJson(x.m_Handle);
+            j["decode"] = get_TraficJson(x.m_Decode);
+            j["queue"] = get_TraficJson(x.m_Queue);
+
+            jTypes.push_back(std::move(j));
+        }
+
+        std::vector<Node::PeerTrafic> vPeers;
+        _node.get_PeersTrafic(vPeers);
+
+        json jPeers = json::array();
+        for (const auto& x : vPeers)
+        {
+            json j = get_TraficJson(x.m_Totals);
+            j["address"] = x.m_Addr.str();
+            jPeers.push_back(std::move(j));
+        }
+
+        io::FragmentPool::Stats ps = io::FragmentPool::get_stats();
+
+        return json{
+            {"types", std::move(jTypes)},
+            {"peers", std::move(jPeers)},
+            {"buffer_pool", json{
+                {"allocs", ps.allocs},
+                {"hits", ps.hits},
+                {"frees", ps.frees},
+                {"released", ps.released},
+            }},
+        };
+    }
+
 #ifdef BEAM_ATOMIC_SWAP_SUPPORT
     json get_swap_offers() override
     {
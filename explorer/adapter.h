@@ -74,6 +74,7 @@ struct IAdapter {
     virtual json get_blocks(Height startHeight, uint64_t n) = 0;
     virtual json get_hdrs(Height hMax, uint64_t nMax, uint64_t dn, const TotalsCol* pCols, uint32_t nCols) = 0;
     virtual json get_peers() = 0;
+    virtual json get_trafic() = 0; // per message type and peer
 
 #ifdef BEAM_ATOMIC_SWAP_SUPPORT
     virtual json get_swap_offers() = 0;
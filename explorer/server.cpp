@@ -795,6 +795,11 @@ OnRequest(peers)
     return _backend.get_peers();
 }
 
+OnRequest(trafic)
+{
+    return _backend.get_trafic();
+}
+
 OnRequest(swap_offers)
 {
     return _backend.get_swap_offers();
@@ -27,6 +27,7 @@
     macro(blocks) \
     macro(hdrs) \
     macro(peers) \
+    macro(trafic) \
     macro(swap_offers) \
     macro(swap_totals) \
     macro(contracts) \
@@ -0,0 +1,471 @@
+// Copyright 2018 The Beam Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bbs_store.h"
+#include "../utility/fsutils.h"
+#include "../utility/logger.h"
+
+namespace beam {
+
+int My_strcmpi(const char* sz1, const char* sz2); // processor.cpp
+
+#pragma pack (push, 1)
+
+struct BbsStore::FileHdr
+{
+	static const uint32_t s_Version = 2;
+
+	Stamp m_Stamp;
+	uintBigFor<uint32_t>::Type m_Version;
+	uintBigFor<uint64_t>::Type m_ID0;
+};
+
+struct BbsStore::RecordHdr
+{
+	Key m_Key;
+	uintBigFor<BbsChannel>::Type m_Channel;
+	uintBigFor<Timestamp>::Type m_TimePosted;
+	uintBigFor<uint32_t>::Type m_Nonce;
+	uintBigFor<uint32_t>::Type m_Size;
+};
+
+#pragma pack (pop)
+
+BbsStore::BbsStore()
+{
+	ZeroObject(m_Totals);
+}
+
+void BbsStore::get_Path(std::string& sPath, const char* szDb)
+{
+	sPath = szDb;
+
+	static const char szSufix[] = ".db";
+	const size_t nSufix = _countof(szSufix) - 1;
+
+	if ((sPath.size() >= nSufix) && !My_strcmpi(sPath.c_str() + sPath.size() - nSufix, szSufix))
+		sPath.resize(sPath.size() - nSufix);
+
+	sPath += "-bbs";
+}
+
+void BbsStore::get_SegmentPath(std::string& sPath, uint32_t iSeq) const
+{
+	char szName[0x20];
+	snprintf(szName, _countof(szName), "/%08x.seg", iSeq);
+
+	sPath = m_sDir;
+	sPath += szName;
+}
+
+void BbsStore::Open(const char* szDir, const Stamp& stamp)
+{
+	Close();
+
+	m_sDir = szDir;
+	m_Stamp = stamp;
+
+#ifdef WIN32
+	fsutils::path pathDir(Utf8toUtf16(szDir));
+#else // WIN32
+	fsutils::path pathDir(szDir);
+#endif // WIN32
+
+	fsutils::create_directories(pathDir);
+
+	std::vector<uint32_t> vSeq;
+	for (fsutils::directory_iterator it(pathDir), itEnd; itEnd != it; ++it)
+	{
+		std::string sName = it->path().filename().string();
+
+		char* szEnd = nullptr;
+		unsigned long nSeq = strtoul(sName.c_str(), &szEnd, 16);
+		if ((szEnd != sName.c_str() + 8) || strcmp(szEnd, ".seg"))
+			continue;
+
+		vSeq.push_back(static_cast<uint32_t>(nSeq));
+	}
+
+	std::sort(vSeq.begin(), vSeq.end());
+
+	for (uint32_t iSeq : vSeq)
+	{
+		auto pSeg = std::make_unique<Segment>();
+		pSeg->m_Seq = iSeq;
+
+		m_SeqNext = iSeq + 1;
+
+		if (LoadSegment(*pSeg) && pSeg->m_Count)
+			m_Segments.push_back(std::move(pSeg));
+		else
+		{
+			pSeg->m_Read.Close();
+
+			std::string sPath;
+			get_SegmentPath(sPath, iSeq);
+			DeleteFile(sPath.c_str());
+		}
+	}
+
+	if (m_Segments.empty() && (m_ID0 > 1))
+		SaveNextID(); // the empty segment was deleted, write it again
+
+	BEAM_LOG_INFO() << "Bbs messages loaded: " << m_Totals.m_Count << ", segments: " << m_Segments.size();
+}
+
+bool BbsStore::LoadSegment(Segment& seg)
+{
+	std::string sPath;
+	get_SegmentPath(sPath, seg.m_Seq);
+
+	auto& fs = seg.m_Read;
+	if (!fs.Open(sPath.c_str(), true))
+		return false;
+
+	FileHdr fh;
+	if (fs.get_Remaining() < sizeof(fh))
+		return false;
+
+	fs.read(&fh, sizeof(fh));
+
+	uint32_t nVer;
+	fh.m_Version.Export(nVer);
+
+	if ((fh.m_Stamp != m_Stamp) || (FileHdr::s_Version != nVer))
+		return false;
+
+	fh.m_ID0.Export(seg.m_ID0);
+
+	uint64_t idNext = m_ID0 + m_Msgs.size();
+	if (seg.m_ID0 < idNext)
+		return false; // IDs must not go back
+
+	if (seg.m_ID0 > idNext)
+	{
+		// gap, i.e. some segment is missing. Drop the older ones, to keep the IDs of the newer
+		while (!m_Segments.empty())
+			EraseFront();
+
+		m_ID0 = seg.m_ID0;
+	}
+
+	seg.m_FileSize = sizeof(fh);
+
+	while (true)
+	{
+		RecordHdr rh;
+		if (fs.get_Remaining() < sizeof(rh))
+			break;
+
+		fs.read(&rh, sizeof(rh));
+
+		Msg m;
+		m.m_Key.m_Key = rh.m_Key;
+		rh.m_Channel.Export(m.m_Channel);
+		rh.m_TimePosted.Export(m.m_TimePosted);
+		rh.m_Nonce.Export(m.m_Nonce);
+		rh.m_Size.Export(m.m_Size);
+		m.m_Pos = seg.m_FileSize + sizeof(rh);
+
+		if (fs.get_Remaining() < m.m_Size)
+			break; // the last record is incomplete
+
+		seg.m_FileSize = m.m_Pos + m.m_Size;
+		fs.Seek(seg.m_FileSize);
+
+		AddToIndex(seg, m);
+	}
+
+	return true;
+}
+
+void BbsStore::Close()
+{
+	m_Write.Close();
+	m_Segments.clear();
+
+	m_Keys.clear();
+	m_Channels.clear();
+	m_Msgs.clear();
+	m_ID0 = 1;
+	m_SeqNext = 0;
+
+	ZeroObject(m_Totals);
+	m_sDir.clear();
+}
+
+void BbsStore::AddToIndex(Segment& seg, const Msg& m)
+{
+	m_Msgs.push_back(m);
+	Msg& x = m_Msgs.back();
+	x.m_ID = m_ID0 + m_Msgs.size() - 1;
+
+	m_Keys.insert(x.m_Key); // in case of duplicate (shouldn't happen) the msg remains, but not indexed by the key
+	m_Channels[x.m_Channel].push_back(x.m_ID);
+
+	if (!seg.m_Count++)
+		seg.m_Time0 = x.m_TimePosted;
+	seg.m_Size += x.m_Size;
+	std::setmax(seg.m_TimeMax, x.m_TimePosted);
+
+	m_Totals.m_Count++;
+	m_Totals.m_Size += x.m_Size;
+}
+
+void BbsStore::WriteFileHdr(std::FStream& fs, uint64_t id0) const
+{
+	FileHdr fh;
+	fh.m_Stamp = m_Stamp;
+	fh.m_Version = FileHdr::s_Version;
+	fh.m_ID0 = id0;
+	fs.write(&fh, sizeof(fh));
+}
+
+BbsStore::Segment& BbsStore::OpenNewSegment()
+{
+	m_Write.Close();
+
+	auto pSeg = std::make_unique<Segment>();
+	Segment& seg = *pSeg;
+
+	seg.m_Seq = m_SeqNext++;
+	seg.m_ID0 = m_ID0 + m_Msgs.size();
+
+	std::string sPath;
+	get_SegmentPath(sPath, seg.m_Seq);
+	m_Write.Open(sPath.c_str(), false, true);
+
+	WriteFileHdr(m_Write, seg.m_ID0);
+	seg.m_FileSize = sizeof(FileHdr);
+
+	m_Segments.push_back(std::move(pSeg));
+	return seg;
+}
+
+uint64_t BbsStore::Insert(const Data& d)
+{
+	assert(IsOpen());
+
+	Segment* pSeg = m_Write.IsOpen() ? m_Segments.back().get() : nullptr;
+	if (!pSeg ||
+		(pSeg->m_Size >= s_SegmentSizeMax) ||
+		(d.m_TimePosted >= pSeg->m_Time0 + m_SegmentSpan_s))
+		pSeg = &OpenNewSegment();
+
+	RecordHdr rh;
+	rh.m_Key = d.m_Key;
+	rh.m_Channel = d.m_Channel;
+	rh.m_TimePosted = d.m_TimePosted;
+	rh.m_Nonce = d.m_Nonce;
+	rh.m_Size = d.m_Message.n;
+
+	m_Write.write(&rh, sizeof(rh));
+	if (d.m_Message.n)
+		m_Write.write(d.m_Message.p, d.m_Message.n);
+	m_Write.Flush(); // make it visible for the read stream
+
+	Msg m;
+	m.m_Key.m_Key = d.m_Key;
+	m.m_Channel = d.m_Channel;
+	m.m_TimePosted = d.m_TimePosted;
+	m.m_Nonce = d.m_Nonce;
+	m.m_Size = d.m_Message.n;
+	m.m_Pos = pSeg->m_FileSize + sizeof(rh);
+
+	pSeg->m_FileSize = m.m_Pos + m.m_Size;
+
+	AddToIndex(*pSeg, m);
+	return get_LastID();
+}
+
+const BbsStore::Msg* BbsStore::Find(const Key& key) const
+{
+	Msg::HKey k;
+	k.m_Key = key;
+
+	auto it = m_Keys.find(k);
+	return (m_Keys.end() == it) ? nullptr : &it->get_ParentObj();
+}
+
+BbsStore::Segment& BbsStore::get_Segment(uint64_t id) const
+{
+	auto it = std::upper_bound(m_Segments.begin(), m_Segments.end(), id, [](uint64_t id_, const Segment::Ptr& pSeg) { return id_ < pSeg->m_ID0; });
+	assert(m_Segments.begin() != it);
+	return **(--it);
+}
+
+void BbsStore::Read(const Msg& m, Data& d, ByteBuffer& buf)
+{
+	Segment& seg = get_Segment(m.m_ID);
+
+	auto& fs = seg.m_Read;
+	if (!fs.IsOpen())
+	{
+		std::string sPath;
+		get_SegmentPath(sPath, seg.m_Seq);
+		fs.Open(sPath.c_str(), true, true);
+	}
+
+	buf.resize(m.m_Size);
+	fs.Seek(m.m_Pos);
+	if (m.m_Size)
+		fs.read(&buf.front(), m.m_Size);
+
+	d.m_Key = m.m_Key.m_Key;
+	d.m_Channel = m.m_Channel;
+	d.m_TimePosted = m.m_TimePosted;
+	d.m_Nonce = m.m_Nonce;
+	d.m_Message = Blob(buf);
+}
+
+const BbsStore::Msg* BbsStore::get_Msg(uint64_t id) const
+{
+	if (id < m_ID0)
+		return nullptr;
+
+	id -= m_ID0;
+	return (id < m_Msgs.size()) ? &m_Msgs[id] : nullptr;
+}
+
+const BbsStore::Msg* BbsStore::get_Next(uint64_t& id) const
+{
+	uint64_t idNext = std::max(id + 1, m_ID0);
+
+	const Msg* pMsg = get_Msg(idNext);
+	if (pMsg)
+		id = idNext;
+
+	return pMsg;
+}
+
+const BbsStore::Msg* BbsStore::get_NextInChannel(BbsChannel ch, uint64_t& id) const
+{
+	auto itCh = m_Channels.find(ch);
+	if (m_Channels.end() == itCh)
+		return nullptr;
+
+	const auto& v = itCh->second;
+	auto it = std::upper_bound(v.begin(), v.end(), id);
+	if (v.end() == it)
+		return nullptr;
+
+	id = *it;
+	return get_Msg(id);
+}
+
+uint64_t BbsStore::FindCursor(Timestamp t) const
+{
+	// segments are ordered by IDs, find the 1st one that contains a msg not older than specified
+	for (const auto& pSeg : m_Segments)
+	{
+		const Segment& seg = *pSeg;
+		if (seg.m_TimeMax < t)
+			continue;
+
+		for (uint64_t id = seg.m_ID0; ; id++)
+		{
+			const Msg* pMsg = get_Msg(id);
+			assert(pMsg);
+			if (pMsg->m_TimePosted >= t)
+				return id;
+		}
+	}
+
+	return get_LastID() + 1;
+}
+
+Timestamp BbsStore::get_MaxTime() const
+{
+	Timestamp ret = 0;
+	for (const auto& pSeg : m_Segments)
+		std::setmax(ret, pSeg->m_TimeMax);
+	return ret;
+}
+
+bool BbsStore::IsInLimits(const NodeDB::BbsTotals& lims) const
+{
+	return
+		(m_Totals.m_Count <= lims.m_Count) &&
+		(m_Totals.m_Size <= lims.m_Size);
+}
+
+uint32_t BbsStore::Cleanup(Timestamp tsMin, const NodeDB::BbsTotals& lims)
+{
+	uint32_t nErased = 0;
+
+	while (!m_Segments.empty())
+	{
+		const Segment& seg = *m_Segments.front();
+		if (IsInLimits(lims) && (seg.m_TimeMax >= tsMin))
+			break;
+
+		nErased += seg.m_Count;
+		EraseFront();
+
+		if (m_Segments.empty())
+			SaveNextID();
+	}
+
+	return nErased;
+}
+
+void BbsStore::EraseFront()
+{
+	assert(!m_Segments.empty());
+	Segment& seg = *m_Segments.front();
+	assert(seg.m_ID0 == m_ID0);
+
+	for (uint32_t i = 0; i < seg.m_Count; i++)
+	{
+		Msg& m = m_Msgs.front();
+
+		if (m.m_Key.is_linked())
+			m_Keys.erase(Msg::KeySet::s_iterator_to(m.m_Key));
+
+		auto itCh = m_Channels.find(m.m_Channel);
+		assert((m_Channels.end() != itCh) && (itCh->second.front() == m.m_ID));
+		itCh->second.pop_front();
+		if (itCh->second.empty())
+			m_Channels.erase(itCh);
+
+		m_Msgs.pop_front();
+		m_ID0++;
+	}
+
+	m_Totals.m_Count -= seg.m_Count;
+	m_Totals.m_Size -= seg.m_Size;
+
+	seg.m_Read.Close();
+	if (1 == m_Segments.size())
+		m_Write.Close();
+
+	std::string sPath;
+	get_SegmentPath(sPath, seg.m_Seq);
+	DeleteFile(sPath.c_str());
+
+	m_Segments.pop_front();
+}
+
+void BbsStore::SaveNextID()
+{
+	// empty segment, not indexed. Deleted on the next load, where the ID is picked
+	std::string sPath;
+	get_SegmentPath(sPath, m_SeqNext++);
+
+	std::FStream fs;
+	fs.Open(sPath.c_str(), false, true);
+	WriteFileHdr(fs, m_ID0);
+}
+
+} // namespace beam
@@ -0,0 +1,127 @@
+// Copyright 2018 The Beam Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "db.h"
+#include <boost/intrusive/set.hpp>
+
+namespace beam {
+
+// Append-only store for BBS messages, kept outside of the node DB.
+// Messages are appended to segment files, each segment covers a limited time span, and is erased as a whole once expired.
+// The index (by key, by channel, by ID) is kept in memory, message bodies are read from the segments on demand.
+// It costs roughly 100 bytes per message, the node limits the message count accordingly.
+// IDs are assigned sequentially upon insertion, each segment keeps the ID of its 1st message, so that they're stable across restarts.
+// If all the segments are erased, an empty segment is left to carry the next ID.
+class BbsStore
+{
+public:
+
+	typedef NodeDB::WalkerBbs::Key Key;
+	typedef NodeDB::WalkerBbs::Data Data;
+	typedef ECC::Hash::Value Stamp;
+
+	struct Msg
+	{
+		struct HKey :public boost::intrusive::set_base_hook<> {
+			Key m_Key;
+			bool operator < (const HKey& x) const { return (m_Key < x.m_Key); }
+			IMPLEMENT_GET_PARENT_OBJ(Msg, m_Key)
+		} m_Key;
+
+		uint64_t m_ID;
+		uint64_t m_Pos; // of the message body within the segment
+		Timestamp m_TimePosted;
+		BbsChannel m_Channel;
+		uint32_t m_Nonce;
+		uint32_t m_Size;
+
+		typedef boost::intrusive::set<HKey> KeySet;
+	};
+
+	static const uint32_t s_SegmentSizeMax = 1024U * 1024U * 64U;
+	uint32_t m_SegmentSpan_s = 3600; // time-partitioning granularity, by message timestamp
+
+	BbsStore();
+	~BbsStore() { Close(); }
+
+	static void get_Path(std::string&, const char* szDb); // derive from the db path
+
+	// Segments with a different stamp (i.e. left from another DB instance) are erased
+	void Open(const char* szDir, const Stamp&);
+	void Close();
+	bool IsOpen() const { return !m_sDir.empty(); }
+
+	const Msg* Find(const Key&) const;
+	uint64_t Insert(const Data&); // must be unique (if not sure - first try to find it). Returns the ID
+	void Read(const Msg&, Data&, ByteBuffer&); // the message body is read into the buffer
+
+	const Msg* get_Next(uint64_t& id) const; // next message with greater ID, updates the ID
+	const Msg* get_NextInChannel(BbsChannel, uint64_t& id) const; // same, within the channel
+	uint64_t FindCursor(Timestamp) const; // lowest ID of the message not older than specified, or next ID if none
+
+	uint64_t get_LastID() const { return m_ID0 + m_Msgs.size() - 1; }
+	Timestamp get_MaxTime() const;
+	const NodeDB::BbsTotals& get_Totals() const { return m_Totals; }
+
+	// Erases the oldest segments while they're expired, or the limits are exceeded. Returns the num of erased messages
+	uint32_t Cleanup(Timestamp tsMin, const NodeDB::BbsTotals& lims);
+
+private:
+
+	struct Segment
+	{
+		uint32_t m_Seq;
+		uint64_t m_ID0;
+		uint32_t m_Count = 0;
+		uint64_t m_Size = 0; // total size of messages
+		uint64_t m_FileSize = 0;
+		Timestamp m_Time0 = 0;
+		Timestamp m_TimeMax = 0;
+		std::FStream m_Read;
+
+		typedef std::unique_ptr<Segment> Ptr;
+	};
+
+	struct FileHdr;
+	struct RecordHdr;
+
+	std::string m_sDir;
+	Stamp m_Stamp;
+
+	std::deque<Msg> m_Msgs; // ordered by ID
+	uint64_t m_ID0 = 1; // ID of the 1st msg
+	Msg::KeySet m_Keys;
+	std::map<BbsChannel, std::deque<uint64_t> > m_Channels;
+
+	std::deque<Segment::Ptr> m_Segments;
+	std::FStream m_Write; // appends to the last segment, if open
+	uint32_t m_SeqNext = 0;
+
+	NodeDB::BbsTotals m_Totals;
+
+	void get_SegmentPath(std::string&, uint32_t iSeq) const;
+	bool LoadSegment(Segment&);
+	void WriteFileHdr(std::FStream&, uint64_t id0) const;
+	Segment& OpenNewSegment();
+	void SaveNextID();
+	Segment& get_Segment(uint64_t id) const;
+	void AddToIndex(Segment&, const Msg&);
+	void EraseFront();
+	bool IsInLimits(const NodeDB::BbsTotals&) const;
+	const Msg* get_Msg(uint64_t id) const;
+};
+
+} // namespace beam
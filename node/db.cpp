@@ -193,6 +193,9 @@ void NodeDB::Statement::Close()
 
 void NodeDB::Close()
 {
+	m_KernelFilter.Reset();
+	m_UniqueFilter.Reset();
+
 	if (m_pDb)
 	{
 		for (size_t i = 0; i < _countof(m_pPrep); i++)
@@ -406,6 +409,7 @@ void NodeDB::Open(const char* szPath)
 
 	if (bCreate)
 	{
+		ExecQuick("PRAGMA auto_vacuum = INCREMENTAL"); // must be set before any table is created
 		Create();
 		ParamIntSet(ParamID::DbVer, nVersionTop);
 	}
@@ -736,9 +740,41 @@ void NodeDB::CreateTables37()
 
 void NodeDB::Vacuum()
 {
+	ExecQuick("PRAGMA auto_vacuum = INCREMENTAL"); // takes effect for existing DBs after the full vacuum
 	ExecQuick("VACUUM");
 }
 
+uint64_t NodeDB::ExecIntOut(const char* szSql)
+{
+	Statement s;
+	Prepare(s, szSql);
+
+	return ExecStep(s.m_pStmt) ? sqlite3_column_int64(s.m_pStmt, 0) : 0;
+}
+
+bool NodeDB::IsVacuumIncremental()
+{
+	return 2 == ExecIntOut("PRAGMA auto_vacuum");
+}
+
+uint64_t NodeDB::get_FreePages()
+{
+	return ExecIntOut("PRAGMA freelist_count");
+}
+
+void NodeDB::VacuumIncremental(uint32_t nPages)
+{
+	char sz[0x40];
+	snprintf(sz, sizeof(sz), "PRAGMA incremental_vacuum(%u)", nPages);
+
+	Statement s;
+	Prepare(s, sz);
+	while (ExecStep(s.m_pStmt))
+		;
+
+	OnModified(); // page moves aren't reported as row changes
+}
+
 void NodeDB::ExecQuick(const char* szSql)
 {
 	int n = sqlite3_total_changes(m_pDb);
@@ -2228,6 +2264,12 @@ void NodeDB::BbsDel(uint64_t id)
 	TestChanged1Row();
 }
 
+void NodeDB::BbsDelAll()
+{
+	Recordset rs(*this, Query::BbsDelAll, "DELETE FROM " TblBbs);
+	rs.Step();
+}
+
 uint64_t NodeDB::BbsIns(const WalkerBbs::Data& d)
 {
 	Recordset rs(*this, Query::BbsIns, "INSERT INTO " TblBbs "(" TblBbs_InsFieldsListed ") VALUES(?,?,?,?,?)");
@@ -2347,6 +2389,8 @@ void NodeDB::InsertKernel(const Blob& key, Height h)
 	rs.put(1, h);
 	rs.Step();
 	TestChanged1Row();
+
+	m_KernelFilter.Insert(key);
 }
 
 void NodeDB::DeleteKernel(const Blob& key, Height h)
@@ -2369,6 +2413,9 @@ void NodeDB::DeleteKernel(const Blob& key, Height h)
 
 Height NodeDB::FindKernel(const Blob& key)
 {
+	if (!TestKeyFilter(m_KernelFilter, key, Query::KernelKeys, "SELECT " TblKernels_Key " FROM " TblKernels))
+		return 0;
+
 	Recordset rs(*this, Query::KernelFind, "SELECT " TblKernels_Height " FROM " TblKernels " WHERE " TblKernels_Key "=? ORDER BY " TblKernels_Height " DESC LIMIT 1");
 	rs.put(0, key);
 	if (!rs.Step())
@@ -2381,6 +2428,124 @@ Height NodeDB::FindKernel(const Blob& key)
 	return h;
 }
 
+void NodeDB::EnumKernels(WalkerKernel& wlk, Height hMin)
+{
+	wlk.m_Rs.Reset(*this, Query::KernelEnum, "SELECT " TblKernels_Key "," TblKernels_Height " FROM " TblKernels " WHERE " TblKernels_Height ">=? ORDER BY " TblKernels_Height);
+	wlk.m_Rs.put(0, hMin);
+}
+
+bool NodeDB::WalkerKernel::MoveNext()
+{
+	if (!m_Rs.Step())
+		return false;
+
+	m_Rs.get(0, m_Key);
+	m_Rs.get(1, m_Height);
+	return true;
+}
+
+bool NodeDB::TestKeyFilter(KeyFilter& kf, const Blob& key, Query::Enum iQuery, const char* szSql)
+{
+	if (kf.m_vBlocks.empty())
+	{
+		std::vector<uint64_t> vHashes;
+
+		Recordset rs(*this, iQuery, szSql);
+		while (rs.Step())
+		{
+			Blob x;
+			rs.get(0, x);
+			vHashes.push_back(KeyFilter::get_Hash(x));
+		}
+
+		kf.Build(vHashes);
+	}
+
+	return kf.MayContain(key);
+}
+
+uint64_t NodeDB::KeyFilter::get_Hash(const Blob& x)
+{
+	// not cryptographic, just well-mixed. Keys are mostly hashes anyway
+	const uint64_t k = 0x9e3779b97f4a7c15ULL;
+	uint64_t h = x.n * k;
+
+	const uint8_t* p = (const uint8_t*) x.p;
+	uint32_t n = x.n;
+
+	for (; n >= sizeof(uint64_t); n -= sizeof(uint64_t), p += sizeof(uint64_t))
+	{
+		uint64_t w;
+		memcpy(&w, p, sizeof(w));
+		h = (h ^ w) * k;
+		h ^= h >> 29;
+	}
+
+	if (n)
+	{
+		uint64_t w = 0;
+		memcpy(&w, p, n);
+		h = (h ^ w) * k;
+	}
+
+	// final avalanche (splitmix64)
+	h ^= h >> 30;
+	h *= 0xbf58476d1ce4e5b9ULL;
+	h ^= h >> 27;
+	h *= 0x94d049bb133111ebULL;
+	h ^= h >> 31;
+
+	return h;
+}
+
+uint64_t NodeDB::KeyFilter::get_Mask(uint64_t h)
+{
+	// 4 bits within the 64-bit block, taken from the upper half of the hash
+	uint64_t msk = 0;
+	for (uint32_t i = 0; i < 4; i++)
+		msk |= uint64_t(1) << ((h >> (32 + i * 6)) & 63);
+	return msk;
+}
+
+size_t NodeDB::KeyFilter::get_Idx(uint64_t h) const
+{
+	// lower half selects the block
+	return static_cast<size_t>(((h & 0xffffffff) * m_vBlocks.size()) >> 32);
+}
+
+void NodeDB::KeyFilter::Build(const std::vector<uint64_t>& vHashes)
+{
+	m_Count = vHashes.size();
+	m_Capacity = std::max<uint64_t>(m_Count * 2, 0x1000); // room to grow
+
+	// ~16 bits per element at full capacity, false positive rate below 1%
+	m_vBlocks.assign(static_cast<size_t>(m_Capacity / 4), 0);
+
+	for (uint64_t h : vHashes)
+		m_vBlocks[get_Idx(h)] |= get_Mask(h);
+}
+
+void NodeDB::KeyFilter::Insert(const Blob& key)
+{
+	if (m_vBlocks.empty())
+		return; // will be built from the table
+
+	if (++m_Count > m_Capacity)
+		Reset(); // overfilled, rebuild on the next lookup
+	else
+	{
+		uint64_t h = get_Hash(key);
+		m_vBlocks[get_Idx(h)] |= get_Mask(h);
+	}
+}
+
+bool NodeDB::KeyFilter::MayContain(const Blob& key) const
+{
+	uint64_t h = get_Hash(key);
+	uint64_t msk = get_Mask(h);
+	return (m_vBlocks[get_Idx(h)] & msk) == msk;
+}
+
 void NodeDB::TxoAdd(TxoID id, const Blob& b)
 {
 	Recordset rs(*this, Query::TxoAdd, "INSERT INTO " TblTxo "(" TblTxo_ID "," TblTxo_Value ") VALUES(?,?)");
@@ -2702,11 +2867,18 @@ bool NodeDB::UniqueInsertSafe(const Blob& key, const Blob* pVal)
 	if (pVal)
 		rs.put(1, *pVal);
 
-	return rs.StepModifySafe();
+	if (!rs.StepModifySafe())
+		return false;
+
+	m_UniqueFilter.Insert(key);
+	return true;
 }
 
 bool NodeDB::UniqueFind(const Blob& key, Recordset& rs)
 {
+	if (!TestKeyFilter(m_UniqueFilter, key, Query::UniqueKeys, "SELECT " TblUnique_Key " FROM " TblUnique))
+		return false;
+
 	rs.Reset(*this, Query::UniqueFind, "SELECT " TblUnique_Value " FROM " TblUnique " WHERE " TblUnique_Key "=?");
 	rs.put(0, key);
 	return rs.Step();
@@ -2727,6 +2899,26 @@ void NodeDB::UniqueDeleteAll()
 	rs.Step();
 }
 
+void NodeDB::UniqueEnum(WalkerUnique& wlk)
+{
+	wlk.m_Rs.Reset(*this, Query::UniqueEnum, "SELECT " TblUnique_Key "," TblUnique_Value " FROM " TblUnique " ORDER BY " TblUnique_Key);
+}
+
+bool NodeDB::WalkerUnique::MoveNext()
+{
+	if (!m_Rs.Step())
+		return false;
+
+	m_Rs.get(0, m_Key);
+
+	if (m_Rs.IsNull(1))
+		m_Val = Blob(nullptr, 0);
+	else
+		m_Rs.get(1, m_Val);
+
+	return true;
+}
+
 bool NodeDB::BridgeInsertSafe(const HeightPos& pos, const Blob& key, const Blob* pVal)
 {
 	Recordset rs(*this, Query::BridgeIns, "INSERT INTO " TblBridge " (" TblBridge_Pos "," TblBridge_Key "," TblBridge_Value ") VALUES(?,?,?)");
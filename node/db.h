@@ -66,6 +66,8 @@ public:
 			TreasuryTotals, // for use in explorer node
 			PbftCid,
 			PbftStamp,
+			ImageCheckpoints,
+			BbsStamp, // pseudo-random, tags the segments of the BBS store that belong to this DB
 		};
 	};
 
@@ -153,6 +155,7 @@ public:
 			BbsIns,
 			BbsMaxTime,
 			BbsTotals,
+			BbsDelAll,
 			DummyIns,
 			DummyFindLowest,
 			DummyFind,
@@ -161,6 +164,8 @@ public:
 			KernelIns,
 			KernelFind,
 			KernelDel,
+			KernelEnum,
+			KernelKeys,
 			TxoAdd,
 			TxoDel,
 			TxoDelFrom,
@@ -175,6 +180,8 @@ public:
 			UniqueFind,
 			UniqueDel,
 			UniqueDelAll,
+			UniqueEnum,
+			UniqueKeys,
 			CacheIns,
 			CacheFind,
 			CacheEnumByHit,
@@ -263,6 +270,11 @@ public:
 	void Vacuum();
 	void CheckIntegrity();
 
+	// online compaction, requires auto_vacuum=INCREMENTAL (new DBs, or after a full Vacuum)
+	bool IsVacuumIncremental();
+	uint64_t get_FreePages();
+	void VacuumIncremental(uint32_t nPages);
+
 	virtual void OnModified() {}
 
 	class Recordset
@@ -525,6 +537,7 @@ public:
 	bool BbsFind(WalkerBbs&); // set Key
 	uint64_t BbsFind(const WalkerBbs::Key&);
 	void BbsDel(uint64_t id);
+	void BbsDelAll();
 	uint64_t BbsFindCursor(Timestamp);
 	Timestamp get_BbsMaxTime();
 	uint64_t get_BbsLastID();
@@ -578,6 +591,16 @@ public:
 	void DeleteKernel(const Blob&, Height h);
 	Height FindKernel(const Blob&); // in case of duplicates - returning the one with the largest Height
 
+	struct WalkerKernel
+	{
+		Recordset m_Rs;
+		Blob m_Key;
+		Height m_Height;
+		bool MoveNext();
+	};
+
+	void EnumKernels(WalkerKernel&, Height hMin);
+
 	uint64_t FindStateWorkGreater(const Difficulty::Raw&);
 
 	void TxoAdd(TxoID, const Blob&);
@@ -699,6 +722,16 @@ public:
 	void UniqueDeleteStrict(const Blob& key);
 	void UniqueDeleteAll();
 
+	struct WalkerUnique
+	{
+		Recordset m_Rs;
+		Blob m_Key;
+		Blob m_Val;
+		bool MoveNext();
+	};
+
+	void UniqueEnum(WalkerUnique&);
+
 	bool BridgeInsertSafe(const HeightPos&, const Blob& key, const Blob* pVal); // returns false if not unique (and doesn't update the value)
 	HeightPos BridgeFind(const Blob& key, Blob& val, Recordset&);
 	void BridgeDeleteFrom(const HeightPos&);
@@ -840,6 +873,32 @@ private:
 
 	Statement m_pPrep[Query::count];
 
+	// In-memory blocked Bloom filter ahead of the lookups that mostly miss (kernels, unique keys).
+	// Insert-only: deletions (and DB tx rollbacks) leave stale bits, which only cost an extra DB lookup.
+	// Built lazily on the first lookup, dropped and rebuilt from the table when overfilled.
+	struct KeyFilter
+	{
+		std::vector<uint64_t> m_vBlocks; // empty if not built
+		uint64_t m_Count;
+		uint64_t m_Capacity;
+
+		static uint64_t get_Hash(const Blob&);
+
+		void Reset() { m_vBlocks.clear(); }
+		void Build(const std::vector<uint64_t>& vHashes);
+		void Insert(const Blob&);
+		bool MayContain(const Blob&) const;
+
+	private:
+		static uint64_t get_Mask(uint64_t h);
+		size_t get_Idx(uint64_t h) const;
+	};
+
+	KeyFilter m_KernelFilter;
+	KeyFilter m_UniqueFilter;
+
+	bool TestKeyFilter(KeyFilter&, const Blob&, Query::Enum, const char* szSql);
+
 	void Prepare(Statement&, const char*);
 
 	void TestRet(int);
@@ -860,6 +919,7 @@ private:
 	void CreateTables37();
 	void ExecQuick(const char*);
 	std::string ExecTextOut(const char*);
+	uint64_t ExecIntOut(const char*);
 	bool ExecStep(sqlite3_stmt*);
 	int ExecStepRaw(sqlite3_stmt*);
 	bool ExecStep(Query::Enum, const char*); // returns true while there's a row
@@ -401,26 +401,43 @@ bool Node::TryAssignTask(Task& t, Peer& p)
 	// assign
 	if (t.m_Key.second)
 	{
+		uint64_t hCountExtra = t.m_sidTrg.m_Number.v - t.m_Key.first.m_Number.v;
+
 		if (m_nTasksPackBody >= m_Cfg.m_MaxConcurrentBlocksRequest)
 		{
-			BEAM_LOG_VERBOSE() << "too many blocks requested";
-			return false; // too many blocks requested
-		}
+			// sync chunks may be requested in parallel, pipelined up to the peer window
+			bool bParallel =
+				hCountExtra &&
+				(nBlocks < p.m_Pipeline.m_Window) &&
+				(m_nTasksBodyMulti < m_Processor.m_SyncChunks.m_Count);
 
-		uint64_t hCountExtra = t.m_sidTrg.m_Number.v - t.m_Key.first.m_Number.v;
+			if (!bParallel)
+			{
+				BEAM_LOG_VERBOSE() << "too many blocks requested";
+				return false; // too many blocks requested
+			}
+		}
 
 		proto::GetBodyPack msg;
 
 		if (t.m_Key.first.m_Number.v <= m_Processor.m_SyncData.m_Target.m_Number.v)
 		{
 			// fast-sync mode, diluted blocks request.
-			msg.m_Top.m_Number = m_Processor.m_SyncData.m_Target.m_Number;
+			NodeDB::StateID sidTop = m_Processor.m_SyncData.m_Target;
+
+			msg.m_Top.m_Number = sidTop.m_Number;
 			if (m_Processor.IsFastSync())
-				m_Processor.get_DB().get_StateHash(m_Processor.m_SyncData.m_Target.m_Row, msg.m_Top.m_Hash);
+			{
+				if (t.m_sidTrg.m_Number.v < sidTop.m_Number.v)
+					sidTop = t.m_sidTrg; // sync chunk
+
+				msg.m_Top.m_Number = sidTop.m_Number;
+				m_Processor.get_DB().get_StateHash(sidTop.m_Row, msg.m_Top.m_Hash);
+			}
 			else
 				msg.m_Top.m_Hash = Zero; // treasury
 
-			msg.m_CountExtra.v = m_Processor.m_SyncData.m_Target.m_Number.v - t.m_Key.first.m_Number.v;
+			msg.m_CountExtra.v = sidTop.m_Number.v - t.m_Key.first.m_Number.v;
 			msg.m_Block0 = m_Processor.m_SyncData.m_n0;
 			msg.m_HorizonLo1 = m_Processor.m_SyncData.m_TxoLo;
 			msg.m_HorizonHi1 = m_Processor.m_SyncData.m_Target.m_Number;
@@ -437,13 +454,15 @@ bool Node::TryAssignTask(Task& t, Peer& p)
 
 		t.m_nCount = std::min(static_cast<uint32_t>(msg.m_CountExtra.v), m_Cfg.m_BandwidthCtl.m_MaxBodyPackCount) + 1; // just an estimate, the actual num of blocks can be smaller
 		m_nTasksPackBody += t.m_nCount;
+		if (t.m_nCount > 1)
+			m_nTasksBodyMulti++;
 
 		t.m_n0 = m_Processor.m_SyncData.m_n0;
 		t.m_nTxoLo = m_Processor.m_SyncData.m_TxoLo;
 	}
 	else
 	{
-		const uint32_t nMaxHdrRequests = proto::g_HdrPackMaxSize * 2;
+		const uint32_t nMaxHdrRequests = proto::g_HdrPackMaxSize * std::max<uint32_t>(2, p.m_Pipeline.m_Window);
 		if (m_nTasksPackHdr >= nMaxHdrRequests)
 		{
 			BEAM_LOG_VERBOSE() << "too many hdrs requested";
@@ -493,13 +512,63 @@ bool Node::TryAssignTask(Task& t, Peer& p)
 	t.m_TimeAssigned_ms = tp.get();
 
 	if (bEmpty)
+	{
+		p.m_Pipeline.m_Done_ms = t.m_TimeAssigned_ms;
 		p.SetTimerWrtFirstTask();
+	}
 
 	BEAM_LOG_DEBUG() << "Peer " << p.m_RemoteAddr << " assigned task " << t.m_Key.first;
 
 	return true;
 }
 
+void Node::TryReassignStraggler(Peer& pIdle)
+{
+	// The lowest sync chunk holds the verification. If it's stuck at a slow peer, while others are already done - request it from the idle peer as well.
+	// The slow peer is not dropped, whichever response comes first is used, the other one is ignored
+	Task* pT = nullptr;
+	for (TaskSet::iterator it = m_setTasks.begin(); m_setTasks.end() != it; ++it)
+	{
+		Task& t = *it;
+		if (t.m_Key.second && (t.m_nCount > 1) && t.m_pOwner)
+		{
+			if (!pT || (pT->m_Key.first.m_Number.v > t.m_Key.first.m_Number.v))
+				pT = &t;
+		}
+	}
+
+	if (!pT || (&pIdle == pT->m_pOwner))
+		return;
+
+	if (pT->m_Key.first.m_Number.v != m_Processor.m_Cursor.m_Full.m_Number.v + 1)
+		return; // doesn't hold anything
+
+	if (m_setTasks.count(*pT) > 1)
+		return; // already requested twice
+
+	PeerManager::TimePoint tp;
+	if (tp.get() - pT->m_TimeAssigned_ms < m_Cfg.m_Timeout.m_SyncChunkStraggler_ms)
+		return;
+
+	Task* pDup = new Task;
+	pDup->m_Key = pT->m_Key;
+	pDup->m_sidTrg = pT->m_sidTrg;
+	pDup->m_bNeeded = true;
+	pDup->m_nCount = 0;
+	pDup->m_pOwner = NULL;
+
+	m_setTasks.insert(*pDup);
+	m_lstTasksUnassigned.push_back(*pDup);
+
+	if (!TryAssignTask(*pDup, pIdle))
+	{
+		DeleteUnassignedTask(*pDup);
+		return;
+	}
+
+	BEAM_LOG_WARNING() << "Peer " << pT->m_pOwner->m_RemoteAddr << " straggles with " << pT->m_Key.first << ", requested from " << pIdle.m_RemoteAddr;
+}
+
 void Node::Peer::SetTimerWrtFirstTask()
 {
 	if (m_lstTasks.empty())
@@ -698,9 +767,7 @@ void Node::Processor::OnNewState()
 		return;
 
 	get_ParentObj().m_TxReject.clear();
-	get_ParentObj().DeleteOutdated(); // Better to delete all irrelevant txs explicitly, even if the node is supposed to mine
-	// because in practice mining could be OFF (for instance, if miner key isn't defined, and owner wallet is offline).
-	get_ParentObj().m_TxDependent.Clear();
+	get_ParentObj().m_CompactRelay.Reset();
 
 	if (get_ParentObj().m_Miner.IsEnabled())
 	{
@@ -716,6 +783,10 @@ void Node::Processor::OnNewState()
 		proto::NewTip msg;
 		msg.m_Description = m_Cursor.m_Full;
 
+		// serialized once for all the peers
+		proto::NodeConnection::Broadcast bcTip, bcCompact;
+		bcTip.Set(msg);
+
 		bool bSendStamp = get_ParentObj().m_Validator.ShouldSendStamp();
 
 		for (PeerList::iterator it = get_ParentObj().m_lstPeers.begin(); get_ParentObj().m_lstPeers.end() != it; ++it)
@@ -745,7 +816,20 @@ void Node::Processor::OnNewState()
 				}
 			}
 
-			peer.Send(msg);
+			bool bCompact = false;
+			if (proto::LoginFlags::CompactBlocks & peer.m_LoginFlags)
+			{
+				CompactRelay& cr = get_ParentObj().m_CompactRelay;
+				if (!cr.m_Built)
+				{
+					cr.Build(); // only when there's a peer to announce it to. Not during the catch-up
+					if (cr.m_Valid)
+						bcCompact.Set(cr.m_Msg);
+				}
+				bCompact = cr.m_Valid;
+			}
+
+			peer.Send(bCompact ? bcCompact : bcTip);
 
 			if (bSendStamp)
 			{
@@ -755,6 +839,11 @@ void Node::Processor::OnNewState()
 		}
 	}
 
+	get_ParentObj().DeleteOutdated(); // Better to delete all irrelevant txs explicitly, even if the node is supposed to mine
+	// because in practice mining could be OFF (for instance, if miner key isn't defined, and owner wallet is offline).
+	// Done after the compact block is built, it refers to the txs of the new block in the pool
+	get_ParentObj().m_TxDependent.Clear();
+
 	get_ParentObj().RefreshCongestions();
 
 	IObserver* pObserver = get_ParentObj().m_Cfg.m_Observer;
@@ -906,6 +995,24 @@ void Node::Processor::OnModified()
 	}
 }
 
+void Node::Processor::StartCompactTimer(uint32_t timeout_ms)
+{
+	if (!m_pCompactTimer)
+		m_pCompactTimer = io::Timer::create(io::Reactor::get_Current());
+
+	m_pCompactTimer->start(timeout_ms, false, [this]() { OnCompactTimer(); });
+}
+
+void Node::Processor::OnCompactTimer()
+{
+	const auto& cfg = get_ParentObj().m_Cfg.m_Compact;
+
+	bool bMore = CompactStep(cfg.m_Slice_ms);
+
+	// leave most of the time to the other stuff
+	StartCompactTimer(bMore ? (cfg.m_Slice_ms * 4) : cfg.m_Idle_ms);
+}
+
 void Node::Processor::TryGoUpAsync()
 {
 	if (!m_bGoUpPending)
@@ -942,6 +1049,11 @@ void Node::Processor::Stop()
 	{
 		m_pFlushTimer->cancel();
 	}
+
+	if (m_pCompactTimer)
+	{
+		m_pCompactTimer->cancel();
+	}
 }
 
 uint32_t Node::Processor::get_MaxAutoRollback()
@@ -1054,6 +1166,9 @@ Node::Peer* Node::AllocPeer(const beam::io::Address& addr)
 	m_lstPeers.push_back(*pPeer);
 
 	pPeer->m_UnsentHiMark = m_Cfg.m_BandwidthCtl.m_Drown;
+	pPeer->m_pDecoderPool = &m_DecoderPool;
+	pPeer->m_pTraficStats = &m_TraficStats;
+	ZeroObject(pPeer->m_Trafic);
 	pPeer->m_pInfo = NULL;
 	pPeer->m_Flags = 0;
 	pPeer->m_Port = 0;
@@ -1096,6 +1211,8 @@ void Node::Initialize()
 	m_Processor.m_ExecutorMT.set_Threads(std::max<uint32_t>(m_Cfg.m_VerificationThreads, 1U));
 
 	m_Processor.m_Horizon = m_Cfg.m_Horizon;
+	m_Processor.m_ImageCheckpoints = m_Cfg.m_ImageCheckpoints;
+	m_Processor.m_SyncChunks = m_Cfg.m_SyncChunks;
 	m_Processor.Initialize(m_Cfg.m_sPathLocal.c_str(), m_Cfg.m_ProcessorParams, m_Cfg.m_Observer ? m_Cfg.m_Observer->GetLongActionHandler() : nullptr);
 
 	if (m_Cfg.m_ProcessorParams.m_EraseSelfID)
@@ -1135,12 +1252,21 @@ void Node::Initialize()
 			m_Beacon.Start();
 	}
 
+	if (m_Cfg.m_DecoderThreads)
+		m_DecoderPool.Start(m_Cfg.m_DecoderThreads);
+
 	m_PeerMan.Initialize();
 	m_Miner.Initialize();
 	m_Validator.OnNewState();
-	m_Processor.get_DB().get_BbsTotals(m_Bbs.m_Totals);
-	m_Bbs.Cleanup();
-	m_Bbs.m_HighestPosted_s = m_Processor.get_DB().get_BbsMaxTime();
+	if (m_Cfg.m_Bbs.IsEnabled())
+		m_Bbs.Initialize();
+	if (m_Cfg.m_Recon.IsEnabled())
+		m_Recon.Initialize();
+	if (m_Cfg.m_LogTraficStats_ms)
+		m_TraficLog.Initialize();
+
+	if (m_Cfg.m_Compact.m_Slice_ms)
+		m_Processor.StartCompactTimer(m_Cfg.m_Compact.m_Idle_ms);
 
 	if (m_Cfg.m_TestMode.m_FakePowSolveTime_ms && (Rules::Consensus::FakePoW == r.m_Consensus))
 		m_PostStartSynced = true;
@@ -1448,31 +1574,72 @@ void Node::RefreshAccounts()
 	BEAM_LOG_INFO() << os.str();
 }
 
-bool Node::Bbs::IsInLimits() const
+void Node::Bbs::Initialize()
 {
-	const NodeDB::BbsTotals& lims = get_ParentObj().m_Cfg.m_Bbs.m_Limit;
+	Node& n = get_ParentObj();
+	NodeDB& db = n.m_Processor.get_DB();
 
-	return
-		(m_Totals.m_Count <= lims.m_Count) &&
-		(m_Totals.m_Size <= lims.m_Size);
+	BbsStore::Stamp stamp;
+	Blob blob(stamp);
+
+	bool bNew = !db.ParamGet(NodeDB::ParamID::BbsStamp, nullptr, &blob);
+	if (bNew)
+	{
+		ECC::GenRandom(stamp);
+		db.ParamSet(NodeDB::ParamID::BbsStamp, nullptr, &blob);
+	}
+
+	std::string sPath;
+	BbsStore::get_Path(sPath, n.m_Cfg.m_sPathLocal.c_str());
+	m_Store.Open(sPath.c_str(), stamp);
+
+	if (bNew)
+		ImportFromDB();
+
+	Cleanup();
+	m_HighestPosted_s = m_Store.get_MaxTime();
 }
 
-void Node::Bbs::Cleanup()
+void Node::Bbs::ImportFromDB()
 {
+	// messages kept in the DB by the older versions
 	NodeDB& db = get_ParentObj().m_Processor.get_DB();
-	NodeDB::WalkerBbsTimeLen wlk;
 
-	Timestamp ts = getTimestamp() - get_ParentObj().m_Cfg.m_Bbs.m_MessageTimeout_s;
+	NodeDB::WalkerBbsLite wlk;
+	NodeDB::WalkerBbs wlkMsg;
+	uint32_t nCount = 0;
 
-	for (db.EnumAllBbs(wlk); wlk.MoveNext(); )
+	wlk.m_ID = 0;
+	for (db.EnumAllBbsSeq(wlk); wlk.MoveNext(); nCount++)
 	{
-		if (IsInLimits() && (wlk.m_Time >= ts))
-			break;
+		wlkMsg.m_Data.m_Key = wlk.m_Key;
+		if (db.BbsFind(wlkMsg) && !m_Store.Find(wlk.m_Key))
+			m_Store.Insert(wlkMsg.m_Data);
+	}
 
-		db.BbsDel(wlk.m_ID);
-		m_Totals.m_Count--;
-		m_Totals.m_Size -= wlk.m_Size;
+	if (nCount)
+	{
+		db.BbsDelAll();
+		BEAM_LOG_INFO() << "Bbs messages imported from DB: " << nCount;
 	}
+}
+
+bool Node::Bbs::IsInLimits() const
+{
+	const NodeDB::BbsTotals& lims = get_ParentObj().m_Cfg.m_Bbs.m_Limit;
+	const NodeDB::BbsTotals& tots = m_Store.get_Totals();
+
+	return
+		(tots.m_Count <= lims.m_Count) &&
+		(tots.m_Size <= lims.m_Size);
+}
+
+void Node::Bbs::Cleanup()
+{
+	const Config::Bbs& cfg = get_ParentObj().m_Cfg.m_Bbs;
+	Timestamp ts = getTimestamp() - cfg.m_MessageTimeout_s;
+
+	m_Store.Cleanup(ts, cfg.m_Limit); // whole segments are erased
 
 	m_LastCleanup_ms = GetTime_ms();
 }
@@ -1576,6 +1743,8 @@ void Node::Peer::GenerateSChannelNonce(ECC::Scalar::Native& nonce)
 
 void Node::Peer::OnTrafic(uint8_t msgCode, uint32_t msgSize, bool bOut)
 {
+	(bOut ? m_Trafic.m_Out : m_Trafic.m_In).Add(msgSize);
+
 	if (m_This.m_Cfg.m_LogTraficUsage)
 		std::cout << "** " << (bOut ? "<-" : "->") << " " << m_RemoteAddr << " Size=" << msgSize << ", Msg=" << static_cast<uint32_t>(msgCode) << '\n';
 }
@@ -1621,6 +1790,12 @@ void Node::Peer::SetupLogin(proto::Login& msg)
 
 	if (m_This.m_Cfg.m_Bbs.IsEnabled())
 		msg.m_Flags |= proto::LoginFlags::Bbs; // indicate ability to receive and broadcast BBS messages
+
+	if (m_This.m_Cfg.m_Recon.IsEnabled())
+		msg.m_Flags |= proto::LoginFlags::Reconciliation;
+
+	if (m_This.m_Cfg.m_CompactBlocks)
+		msg.m_Flags |= proto::LoginFlags::CompactBlocks;
 }
 
 void Node::Peer::PbftSendStamp()
@@ -1893,6 +2068,13 @@ void Node::Peer::ReleaseTask(Task& t)
 		assert(nCounter >= t.m_nCount);
 
 		nCounter -= t.m_nCount;
+
+		if (t.m_Key.second && (t.m_nCount > 1))
+		{
+			assert(m_This.m_nTasksBodyMulti);
+			m_This.m_nTasksBodyMulti--;
+		}
+
 		t.m_nCount = 0;
 	}
 
@@ -2021,7 +2203,123 @@ void Node::Peer::OnMsg(proto::NewTip&& msg)
 	if (msg.m_Description.m_ChainWork < m_Tip.m_Full.m_ChainWork)
 		ThrowUnexpected();
 
-	m_Tip.m_Full = msg.m_Description;
+	m_CompactRelay.m_Pending = false; // superseded
+	OnTip(msg.m_Description);
+}
+
+void Node::Peer::OnMsg(proto::CompactBlock&& msg)
+{
+	if (msg.m_Description.m_ChainWork < m_Tip.m_Full.m_ChainWork)
+		ThrowUnexpected();
+
+	m_CompactRelay.m_Pending = false; // superseded
+
+	Processor& p = m_This.m_Processor;
+
+	NodeProcessor::Tip tip;
+	tip.m_Full = msg.m_Description;
+	tip.m_Full.get_ID(tip.m_hh);
+
+	if (m_This.m_Cfg.m_CompactBlocks && m_pInfo && !p.IsFastSync() && !Rules::get().IsPbftWhitelistMode() && p.m_Cursor.IsRemoteNeeded(tip))
+	{
+		Block::Body& block = m_CompactRelay.m_Body;
+		block = Block::Body();
+
+		proto::GetCompactMissing msgOut;
+		if (!m_This.m_CompactRelay.Decode(block, msg, msgOut))
+			ThrowUnexpected();
+
+		if (!msgOut.m_Inputs.empty() || !msgOut.m_Outputs.empty() || !msgOut.m_Kernels.empty())
+		{
+			// defer the tip handling until the missing elements arrive, to avoid requesting the whole body meanwhile
+			msg.m_Description.get_ID(msgOut.m_ID);
+			m_CompactRelay.m_Msg = std::move(msg);
+			m_CompactRelay.m_Pending = true;
+			Send(msgOut);
+			return;
+		}
+
+		OnCompactBlock(msg, block);
+	}
+
+	OnTip(msg.m_Description);
+}
+
+void Node::Peer::OnMsg(proto::GetCompactMissing&& msg)
+{
+	proto::CompactMissing msgOut;
+	msgOut.m_ID = msg.m_ID;
+
+	if (!m_This.m_CompactRelay.Fetch(msgOut, msg))
+		ThrowUnexpected();
+
+	Send(msgOut);
+}
+
+void Node::Peer::OnMsg(proto::CompactMissing&& msg)
+{
+	if (!m_CompactRelay.m_Pending)
+		return; // superseded
+
+	proto::CompactBlock& cb = m_CompactRelay.m_Msg;
+
+	Block::SystemState::ID id;
+	cb.m_Description.get_ID(id);
+	if (id != msg.m_ID)
+		return; // reply to a superseded request
+
+	m_CompactRelay.m_Pending = false;
+
+	if (m_This.m_CompactRelay.Fill(m_CompactRelay.m_Body, msg))
+		OnCompactBlock(cb, m_CompactRelay.m_Body);
+	else
+		BEAM_LOG_INFO() << id << " Compact block missing elements not provided";
+
+	OnTip(cb.m_Description);
+	m_CompactRelay.m_Body = Block::Body();
+}
+
+void Node::Peer::OnCompactBlock(proto::CompactBlock& msg, Block::Body& block)
+{
+	Block::SystemState::ID id;
+	msg.m_Description.get_ID(id);
+
+	ByteBuffer bufP, bufE;
+	ECC::Hash::Value hvP, hvE;
+
+	Serializer ser;
+	ser & Cast::Down<Block::BodyBase>(block);
+	ser & Cast::Down<TxVectors::Perishable>(block);
+	ser.swap_buf(bufP);
+	proto::CompactRelay::get_Hash(hvP, bufP);
+
+	ser.reset();
+	ser & Cast::Down<TxVectors::Eternal>(block);
+	ser.swap_buf(bufE);
+	proto::CompactRelay::get_Hash(hvE, bufE);
+
+	if ((hvP != msg.m_HashP) || (hvE != msg.m_HashE))
+	{
+		// short IDs collision, or non-standard encoding. Not necessarily malicious, the body will be downloaded as usual
+		BEAM_LOG_INFO() << id << " Compact block reconstruction mismatch";
+		return;
+	}
+
+	Processor& p = m_This.m_Processor;
+	if (NodeProcessor::DataStatus::Invalid == p.OnState(msg.m_Description, m_pInfo->m_ID.m_Key))
+		return; // will be handled with the tip
+
+	if (NodeProcessor::DataStatus::Accepted == p.OnBlock(id, bufP, bufE, m_pInfo->m_ID.m_Key))
+	{
+		BEAM_LOG_INFO() << id << " Compact block reconstructed";
+		m_This.m_CompactRelay.m_Stats.m_Reconstructed++;
+		p.TryGoUpAsync();
+	}
+}
+
+void Node::Peer::OnTip(const Block::SystemState::Full& s)
+{
+	m_Tip.m_Full = s;
 	m_Tip.m_Full.get_ID(m_Tip.m_hh);
 
 	m_setRejected.clear();
@@ -2084,6 +2382,8 @@ Node::Task& Node::Peer::get_FirstTask()
 
 void Node::Peer::OnFirstTaskDone()
 {
+	m_Pipeline.m_Done_ms = PeerManager::TimePoint().get();
+
 	ReleaseTask(get_FirstTask());
 	SetTimerWrtFirstTask();
 
@@ -2095,7 +2395,9 @@ void Node::Peer::OnFirstTaskDone()
 void Node::Peer::ModifyRatingWrtData(size_t nSize)
 {
 	PeerManager::TimePoint tp;
-	uint32_t dt_ms = tp.get() - get_FirstTask().m_TimeAssigned_ms;
+
+	bool bIdle;
+	uint32_t dt_ms = tp.get() - m_Pipeline.get_Start_ms(get_FirstTask().m_TimeAssigned_ms, bIdle);
 
 	// Calculate the weighted average of the effective bandwidth.
 	// We assume the "previous" bandwidth bw0 was calculated within "previous" window t0, and the total download amount was v0 = t0 * bw0.
@@ -2114,11 +2416,53 @@ void Node::Peer::ModifyRatingWrtData(size_t nSize)
 
 	uint32_t nRatingAvg = PeerManager::Rating::FromBps(bwAvg);
 
+	m_Pipeline.OnResponse(nSize, dt_ms, bIdle, bw0, bwAvg, m_This.m_Cfg.m_BandwidthCtl.m_MaxPipeline);
+
 	m_This.m_PeerMan.m_LiveSet.erase(PeerMan::LiveSet::s_iterator_to(Cast::Up<PeerMan::PeerInfoPlus>(m_pInfo)->m_Live));
 	m_This.m_PeerMan.SetRating(*m_pInfo, nRatingAvg);
 	m_This.m_PeerMan.m_LiveSet.insert(Cast::Up<PeerMan::PeerInfoPlus>(m_pInfo)->m_Live);
 }
 
+uint32_t Node::Pipeline::get_Start_ms(uint32_t tAssigned_ms, bool& bIdle) const
+{
+	bIdle = (static_cast<int32_t>(m_Done_ms - tAssigned_ms) <= 0);
+	return bIdle ? tAssigned_ms : m_Done_ms;
+}
+
+void Node::Pipeline::OnResponse(size_t nSize, uint32_t dt_ms, bool bIdle, uint32_t nBps0, uint32_t nBpsAvg, uint32_t nMax)
+{
+	if (!nSize)
+	{
+		m_Window = 1;
+		return;
+	}
+
+	if (bIdle && nBps0)
+	{
+		// the rest is the latency
+		uint64_t tx_ms = static_cast<uint64_t>(nSize) * 1000 / nBps0;
+		uint32_t nRtt_ms = (dt_ms > tx_ms) ? static_cast<uint32_t>(dt_ms - tx_ms) : 0;
+		m_Rtt_ms = m_Rtt_ms ? ((m_Rtt_ms * 3 + nRtt_ms) / 4) : std::max<uint32_t>(nRtt_ms, 1);
+	}
+
+	m_SizeAvg = m_SizeAvg ? ((m_SizeAvg * 3 + nSize) / 4) : nSize;
+
+	Update(nBpsAvg, nMax);
+}
+
+void Node::Pipeline::Update(uint32_t nBps, uint32_t nMax)
+{
+	uint32_t nWindow = 1;
+	if (m_Rtt_ms && m_SizeAvg)
+	{
+		// bandwidth-delay product, in terms of the typical response
+		uint64_t nBdp = static_cast<uint64_t>(nBps) * m_Rtt_ms / 1000;
+		nWindow += static_cast<uint32_t>(std::min<uint64_t>((nBdp + m_SizeAvg - 1) / m_SizeAvg, nMax));
+	}
+
+	m_Window = std::max<uint32_t>(std::min(nWindow, nMax), 1);
+}
+
 void Node::Peer::OnMsg(proto::DataMissing&&)
 {
 	Task& t = get_FirstTask();
@@ -2281,6 +2625,9 @@ void Node::Peer::OnMsg(proto::GetBody&& msg)
 
 void Node::Peer::OnMsg(proto::GetBodyPack&& msg)
 {
+	if (msg.m_CountExtra.v && m_This.m_Cfg.m_TestMode.m_StallBodyPacks)
+		return;
+
 	Processor& p = m_This.m_Processor; // alias
 
 	if (msg.m_Top.m_Number.v)
@@ -2501,6 +2848,9 @@ void Node::Peer::OnMsg(proto::BodyPack&& msg)
 
 	p.TryGoUpAsync();
 	OnFirstTaskDone(eStatus);
+
+	if (m_lstTasks.empty())
+		m_This.TryReassignStraggler(*this);
 }
 
 void Node::Peer::OnFirstTaskDone(NodeProcessor::DataStatus::Enum eStatus)
@@ -3229,7 +3579,8 @@ void Node::OnTransactionFluff(TxPool::Fluff::Element& x, const PeerID* pSender)
 		if (!(peer.m_LoginFlags & proto::LoginFlags::SpreadingTransactions) || peer.IsChocking())
 			continue;
 
-		peer.Send(msgOut);
+		if (!peer.ReconAdd(proto::Recon::Type::Tx, msgOut.m_ID))
+			peer.Send(msgOut);
 		peer.SetTxCursor(x.m_pSend);
 	}
 
@@ -3399,6 +3750,18 @@ void Node::Peer::OnLogin(proto::Login&& msg, uint32_t nFlagsPrev)
 
 	m_This.m_Validator.SendState(*this);
 
+	for (uint8_t i = 0; i < proto::Recon::Type::count; i++)
+	{
+		if (IsReconActive(i))
+			continue;
+
+		// don't lose the keys that were deferred for reconciliation, announce them in a standard way
+		if (get_ReconLoginFlag(i) & m_LoginFlags)
+			ReconFlush(i);
+
+		m_Recon.m_pSet[i] = Recon::Set();
+	}
+
 	BroadcastTxs();
 	BroadcastBbs();
 }
@@ -3467,6 +3830,9 @@ void Node::Peer::BroadcastTxs()
 			continue; // already deleted
 		auto& x = *m_pCursorTx->m_pThis;
 
+		if (ReconAdd(proto::Recon::Type::Tx, x.m_Tx.m_Key))
+			continue;
+
 		proto::HaveTransaction msgOut;
 		msgOut.m_ID = x.m_Tx.m_Key;
 		Send(msgOut);
@@ -3488,22 +3854,553 @@ void Node::Peer::BroadcastBbs()
 
 	size_t nExtra = 0;
 
-	NodeDB& db = m_This.m_Processor.get_DB();
-	NodeDB::WalkerBbsLite wlk;
+	const BbsStore& st = m_This.m_Bbs.m_Store;
 
-	wlk.m_ID = m_CursorBbs;
-	for (db.EnumAllBbsSeq(wlk); wlk.MoveNext(); )
+	for (const BbsStore::Msg* pMsg; (pMsg = st.get_Next(m_CursorBbs)); )
 	{
+		if (ReconAdd(proto::Recon::Type::Bbs, pMsg->m_Key.m_Key))
+			continue;
+
 		proto::BbsHaveMsg msgOut;
-		msgOut.m_Key = wlk.m_Key;
+		msgOut.m_Key = pMsg->m_Key.m_Key;
 		Send(msgOut);
 
-		nExtra += wlk.m_Size;
+		nExtra += pMsg->m_Size;
 		if (IsChocking(nExtra))
 			break;
 	}
+}
 
-	m_CursorBbs = wlk.m_ID;
+uint32_t Node::Peer::get_ReconLoginFlag(uint8_t nType)
+{
+	return (proto::Recon::Type::Tx == nType) ?
+		proto::LoginFlags::SpreadingTransactions :
+		proto::LoginFlags::Bbs;
+}
+
+bool Node::Peer::IsReconActive(uint8_t nType) const
+{
+	if (!m_This.m_Cfg.m_Recon.IsEnabled() || !(proto::LoginFlags::Reconciliation & m_LoginFlags))
+		return false;
+
+	return !!(get_ReconLoginFlag(nType) & m_LoginFlags);
+}
+
+bool Node::Peer::ReconAdd(uint8_t nType, const Recon::Key& key)
+{
+	if (!IsReconActive(nType))
+		return false;
+
+	auto& x = m_Recon.m_pSet[nType];
+	if (x.m_Pending.size() >= m_This.m_Cfg.m_Recon.m_PendingMax)
+		return false;
+
+	x.m_Pending.insert(key);
+	return true;
+}
+
+void Node::Peer::ReconSendHave(uint8_t nType, const Recon::Key& key)
+{
+	if (proto::Recon::Type::Tx == nType)
+	{
+		proto::HaveTransaction msg;
+		msg.m_ID = key;
+		Send(msg);
+	}
+	else
+	{
+		proto::BbsHaveMsg msg;
+		msg.m_Key = key;
+		Send(msg);
+	}
+}
+
+void Node::Peer::ReconFlush(uint8_t nType)
+{
+	auto& x = m_Recon.m_pSet[nType];
+
+	for (const auto& key : x.m_Pending)
+		ReconSendHave(nType, key);
+	for (const auto& v : x.m_Sent)
+		ReconSendHave(nType, v.second);
+
+	x.m_Pending.clear();
+	x.m_Sent.clear();
+	x.m_Ticks = 0;
+	x.m_Wait = 0;
+}
+
+void Node::Peer::ReconOnTimer()
+{
+	for (uint8_t i = 0; i < proto::Recon::Type::count; i++)
+	{
+		if (!IsReconActive(i))
+			continue;
+
+		auto& x = m_Recon.m_pSet[i];
+		if (x.m_Ticks)
+		{
+			if (++x.m_Ticks <= m_This.m_Cfg.m_Recon.m_RoundTimeout)
+				continue;
+
+			ReconFlush(i); // peer doesn't respond
+		}
+		else
+		{
+			// the rounds are initiated by the connecting side
+			if (!(Flags::Accepted & m_Flags) && !IsChocking())
+				ReconStart(i);
+			else
+			{
+				if (x.m_Pending.empty())
+					x.m_Wait = 0;
+				else
+				{
+					if (++x.m_Wait > m_This.m_Cfg.m_Recon.m_RoundTimeout + 1)
+						ReconFlush(i); // no round in time
+				}
+			}
+		}
+	}
+}
+
+void Node::Peer::ReconStart(uint8_t nType)
+{
+	auto& x = m_Recon.m_pSet[nType];
+	assert(!x.m_Ticks && x.m_Sent.empty());
+
+	ECC::GenRandom(&x.m_Salt, sizeof(x.m_Salt));
+
+	proto::Recon::Sketch sk;
+	sk.Init(proto::Recon::Sketch::get_CellsFor(x.m_DiffEst));
+
+	for (const auto& key : x.m_Pending)
+	{
+		uint64_t id = proto::Recon::get_ShortID(key, x.m_Salt);
+		if (x.m_Sent.emplace(id, key).second)
+			sk.Add(id);
+		else
+			ReconSendHave(nType, key); // short ID collision
+	}
+
+	x.m_Pending.clear();
+	x.m_Wait = 0;
+
+	proto::ReconSketch msg;
+	msg.m_Type = nType;
+	msg.m_Salt = x.m_Salt;
+	sk.Write(msg.m_Cells);
+	Send(msg);
+
+	x.m_Ticks = 1;
+}
+
+void Node::Peer::OnMsg(proto::ReconSketch&& msg)
+{
+	if (!m_This.m_Cfg.m_Recon.IsEnabled() || (msg.m_Type >= proto::Recon::Type::count))
+		ThrowUnexpected();
+
+	proto::Recon::Sketch sk;
+	if (!sk.Read(msg.m_Cells))
+		ThrowUnexpected("bad recon sketch");
+
+	auto& x = m_Recon.m_pSet[msg.m_Type];
+
+	proto::Recon::Sketch skMy;
+	skMy.Init(sk.get_Cells());
+
+	std::map<uint64_t, Recon::Key> mapMy;
+	for (const auto& key : x.m_Pending)
+	{
+		uint64_t id = proto::Recon::get_ShortID(key, msg.m_Salt);
+		if (mapMy.emplace(id, key).second)
+			skMy.Add(id);
+		else
+			ReconSendHave(msg.m_Type, key);
+	}
+
+	x.m_Pending.clear();
+	x.m_Wait = 0;
+
+	proto::ReconRequest msgOut;
+	msgOut.m_Type = msg.m_Type;
+	msgOut.m_Salt = msg.m_Salt;
+
+	std::vector<uint64_t> vMy;
+	sk.Subtract(skMy);
+	msgOut.m_All = !sk.Decode(msgOut.m_IDs, vMy);
+
+	if (msgOut.m_All)
+	{
+		// difference is too big, fall back to full exchange
+		msgOut.m_IDs.clear();
+		for (const auto& v : mapMy)
+			ReconSendHave(msg.m_Type, v.second);
+	}
+	else
+	{
+		for (uint64_t id : vMy)
+		{
+			auto it = mapMy.find(id);
+			if (mapMy.end() != it)
+				ReconSendHave(msg.m_Type, it->second);
+		}
+	}
+
+	Send(msgOut);
+}
+
+void Node::Peer::OnMsg(proto::ReconRequest&& msg)
+{
+	if (!m_This.m_Cfg.m_Recon.IsEnabled() || (msg.m_Type >= proto::Recon::Type::count))
+		ThrowUnexpected();
+
+	auto& x = m_Recon.m_pSet[msg.m_Type];
+	if (!x.m_Ticks || (x.m_Salt != msg.m_Salt))
+		return; // outdated, the round was already flushed
+
+	const uint32_t nCellsMax = proto::Recon::Sketch::s_CellsMax;
+
+	if (msg.m_All)
+	{
+		for (const auto& v : x.m_Sent)
+			ReconSendHave(msg.m_Type, v.second);
+
+		x.m_DiffEst = std::min(x.m_DiffEst * 2 + proto::Recon::Sketch::s_CellsMin, nCellsMax);
+	}
+	else
+	{
+		for (uint64_t id : msg.m_IDs)
+		{
+			auto it = x.m_Sent.find(id);
+			if (x.m_Sent.end() != it)
+				ReconSendHave(msg.m_Type, it->second);
+		}
+
+		x.m_DiffEst -= x.m_DiffEst / 4;
+		std::setmax(x.m_DiffEst, static_cast<uint32_t>(std::min<size_t>(msg.m_IDs.size() * 2, nCellsMax)));
+	}
+
+	x.m_Sent.clear();
+	x.m_Ticks = 0;
+}
+
+void Node::Recon::Initialize()
+{
+	m_pTimer = io::Timer::create(io::Reactor::get_Current());
+	m_pTimer->start(get_ParentObj().m_Cfg.m_Recon.m_Period_ms, true, [this]() { OnTimer(); });
+}
+
+void Node::Recon::OnTimer()
+{
+	PeerList& lst = get_ParentObj().m_lstPeers;
+	for (PeerList::iterator it = lst.begin(); lst.end() != it; ++it)
+		it->ReconOnTimer();
+}
+
+void Node::CompactRelay::Known::Add(const TxVectors::Full& txv, uint64_t nSalt)
+{
+	for (const auto& pInp : txv.m_vInputs)
+		m_Inputs[proto::CompactRelay::get_ShortID(*pInp, nSalt)] = pInp.get();
+
+	for (const auto& pOutp : txv.m_vOutputs)
+		m_Outputs[proto::CompactRelay::get_ShortID(*pOutp, nSalt)] = pOutp.get();
+
+	for (const auto& pKrn : txv.m_vKernels)
+		m_Kernels[proto::CompactRelay::get_ShortID(*pKrn, nSalt)] = pKrn.get();
+}
+
+void Node::CompactRelay::Known::Add(const TxPool::Fluff& txp, uint64_t nSalt, bool bFluffedOnly)
+{
+	for (TxPool::Fluff::TxSet::const_iterator it = txp.m_setTxs.begin(); txp.m_setTxs.end() != it; ++it)
+	{
+		const TxPool::Fluff::Element& x = it->get_ParentObj();
+		if (bFluffedOnly && (TxPool::Fluff::State::PreFluffed == x.m_State))
+			continue; // not broadcasted yet
+
+		Add(*x.m_pValue, nSalt);
+	}
+}
+
+void Node::CompactRelay::Clone(Input::Ptr& p, const Input& v)
+{
+	p = std::make_unique<Input>();
+	*p = v;
+}
+
+void Node::CompactRelay::Clone(Output::Ptr& p, const Output& v)
+{
+	p = std::make_unique<Output>();
+	*p = v;
+}
+
+void Node::CompactRelay::Clone(TxKernel::Ptr& p, const TxKernel& v)
+{
+	v.Clone(p);
+}
+
+bool Node::CompactRelay::IsEnabled() const
+{
+	return get_ParentObj().m_Cfg.m_CompactBlocks && (Rules::Consensus::Pbft != Rules::get().m_Consensus);
+}
+
+void Node::CompactRelay::Reset()
+{
+	m_Built = false;
+	m_Valid = false;
+	m_Body = Block::Body();
+}
+
+void Node::CompactRelay::Build()
+{
+	assert(!m_Built);
+	m_Built = true;
+
+	if (!IsEnabled())
+		return;
+
+	Node& n = get_ParentObj();
+	Processor& p = n.m_Processor;
+	if (!p.m_Cursor.m_Full.m_Number.v)
+		return;
+
+	ByteBuffer bufP, bufE;
+	if (!p.GetBlock(p.m_Cursor.get_Sid(), &bufE, &bufP, Block::Number(0), Block::Number(0), Block::Number(0), true))
+		return;
+
+	Deserializer der;
+	der.reset(bufP);
+	der & Cast::Down<Block::BodyBase>(m_Body);
+	der & Cast::Down<TxVectors::Perishable>(m_Body);
+
+	der.reset(bufE);
+	der & Cast::Down<TxVectors::Eternal>(m_Body);
+
+	proto::CompactBlock& msg = m_Msg;
+	msg = proto::CompactBlock();
+
+	msg.m_Description = p.m_Cursor.m_Full;
+	msg.m_Base = Cast::Down<Block::BodyBase>(m_Body);
+	ECC::GenRandom(&msg.m_Salt, sizeof(msg.m_Salt));
+
+	// elements of the txs the peers are expected to have are sent as short IDs, the rest are prefilled
+	Known kn;
+	kn.Add(n.m_TxPool, msg.m_Salt, true);
+
+	Encode(msg.m_Inputs, msg.m_PrefilledP.m_vInputs, m_Body.m_vInputs, kn.m_Inputs, msg.m_Salt);
+	Encode(msg.m_Outputs, msg.m_PrefilledP.m_vOutputs, m_Body.m_vOutputs, kn.m_Outputs, msg.m_Salt);
+	Encode(msg.m_Kernels, msg.m_PrefilledE.m_vKernels, m_Body.m_vKernels, kn.m_Kernels, msg.m_Salt);
+
+	proto::CompactRelay::get_Hash(msg.m_HashP, bufP);
+	proto::CompactRelay::get_Hash(msg.m_HashE, bufE);
+
+	m_Valid = true;
+	m_Stats.m_Built++;
+}
+
+template <typename TPtr, typename TMap>
+void Node::CompactRelay::Encode(std::vector<uint64_t>& vIDs, std::vector<TPtr>& vPrefilled, const std::vector<TPtr>& v, const TMap& mapKnown, uint64_t nSalt)
+{
+	vIDs.reserve(v.size());
+
+	for (const auto& pElem : v)
+	{
+		uint64_t id = proto::CompactRelay::get_ShortID(*pElem, nSalt);
+		if (mapKnown.end() == mapKnown.find(id))
+		{
+			vIDs.push_back(0);
+			vPrefilled.emplace_back();
+			Clone(vPrefilled.back(), *pElem);
+		}
+		else
+			vIDs.push_back(id);
+	}
+}
+
+bool Node::CompactRelay::Decode(Block::Body& block, proto::CompactBlock& msg, proto::GetCompactMissing& msgOut) const
+{
+	Cast::Down<Block::BodyBase>(block) = msg.m_Base;
+
+	Known kn;
+	kn.Add(get_ParentObj().m_TxPool, msg.m_Salt, false);
+
+	return
+		Decode(block.m_vInputs, msgOut.m_Inputs, msg.m_Inputs, msg.m_PrefilledP.m_vInputs, kn.m_Inputs) &&
+		Decode(block.m_vOutputs, msgOut.m_Outputs, msg.m_Outputs, msg.m_PrefilledP.m_vOutputs, kn.m_Outputs) &&
+		Decode(block.m_vKernels, msgOut.m_Kernels, msg.m_Kernels, msg.m_PrefilledE.m_vKernels, kn.m_Kernels);
+}
+
+template <typename TPtr, typename TMap>
+bool Node::CompactRelay::Decode(std::vector<TPtr>& v, std::vector<uint32_t>& vMissing, const std::vector<uint64_t>& vIDs, std::vector<TPtr>& vPrefilled, const TMap& mapKnown)
+{
+	v.resize(vIDs.size());
+	size_t iPrefilled = 0;
+
+	for (size_t i = 0; i < vIDs.size(); i++)
+	{
+		if (vIDs[i])
+		{
+			auto it = mapKnown.find(vIDs[i]);
+			if (mapKnown.end() == it)
+				vMissing.push_back(static_cast<uint32_t>(i));
+			else
+				Clone(v[i], *it->second);
+		}
+		else
+		{
+			if ((iPrefilled == vPrefilled.size()) || !vPrefilled[iPrefilled])
+				return false;
+			v[i] = std::move(vPrefilled[iPrefilled++]);
+		}
+	}
+
+	return (vPrefilled.size() == iPrefilled);
+}
+
+bool Node::CompactRelay::Fetch(proto::CompactMissing& msgOut, const proto::GetCompactMissing& msg) const
+{
+	if (!m_Valid)
+		return true; // empty reply
+
+	Block::SystemState::ID id;
+	m_Msg.m_Description.get_ID(id);
+	if (id != msg.m_ID)
+		return true; // no longer cached, empty reply
+
+	return
+		Fetch(msgOut.m_Perishable.m_vInputs, m_Body.m_vInputs, msg.m_Inputs) &&
+		Fetch(msgOut.m_Perishable.m_vOutputs, m_Body.m_vOutputs, msg.m_Outputs) &&
+		Fetch(msgOut.m_Eternal.m_vKernels, m_Body.m_vKernels, msg.m_Kernels);
+}
+
+template <typename TPtr>
+bool Node::CompactRelay::Fetch(std::vector<TPtr>& vOut, const std::vector<TPtr>& v, const std::vector<uint32_t>& vIdx)
+{
+	vOut.reserve(vIdx.size());
+
+	for (uint32_t i : vIdx)
+	{
+		if (i >= v.size())
+			return false;
+
+		vOut.emplace_back();
+		Clone(vOut.back(), *v[i]);
+	}
+
+	return true;
+}
+
+bool Node::CompactRelay::Fill(Block::Body& block, proto::CompactMissing& msg)
+{
+	return
+		Fill(block.m_vInputs, msg.m_Perishable.m_vInputs) &&
+		Fill(block.m_vOutputs, msg.m_Perishable.m_vOutputs) &&
+		Fill(block.m_vKernels, msg.m_Eternal.m_vKernels);
+}
+
+template <typename TPtr>
+bool Node::CompactRelay::Fill(std::vector<TPtr>& v, std::vector<TPtr>& vMissing)
+{
+	size_t iMissing = 0;
+
+	for (auto& pElem : v)
+	{
+		if (pElem)
+			continue;
+
+		if ((iMissing == vMissing.size()) || !vMissing[iMissing])
+			return false;
+		pElem = std::move(vMissing[iMissing++]);
+	}
+
+	return (vMissing.size() == iMissing);
+}
+
+void Node::get_PeersTrafic(std::vector<PeerTrafic>& v) const
+{
+	for (PeerList::const_iterator it = m_lstPeers.begin(); m_lstPeers.end() != it; ++it)
+	{
+		const Peer& peer = *it;
+		if (!(Peer::Flags::Connected & peer.m_Flags))
+			continue;
+
+		PeerTrafic& x = v.emplace_back();
+		x.m_Addr = peer.m_RemoteAddr;
+		x.m_Totals = peer.m_Trafic;
+	}
+}
+
+void Node::TraficLog::Initialize()
+{
+	m_pTimer = io::Timer::create(io::Reactor::get_Current());
+	m_pTimer->start(get_ParentObj().m_Cfg.m_LogTraficStats_ms, true, [this]() { OnTimer(); });
+}
+
+void Node::TraficLog::OnTimer()
+{
+	const Node& n = get_ParentObj();
+	const proto::TraficStats& ts = n.m_TraficStats;
+
+	std::vector<uint8_t> vCodes;
+	for (uint32_t i = 0; i < _countof(ts.m_pType); i++)
+	{
+		const auto& x = ts.m_pType[i];
+		if (x.m_In.m_Msgs || x.m_Out.m_Msgs)
+			vCodes.push_back(static_cast<uint8_t>(i));
+	}
+
+	auto fnBytes = [&ts](uint8_t i) { return ts.m_pType[i].m_In.m_Bytes + ts.m_pType[i].m_Out.m_Bytes; };
+
+	std::sort(vCodes.begin(), vCodes.end(), [&fnBytes](uint8_t a, uint8_t b) { return fnBytes(a) > fnBytes(b); });
+
+	BEAM_LOG_INFO() << "Trafic by message type:";
+	for (size_t i = 0; (i < vCodes.size()) && (i < s_Top); i++)
+	{
+		const auto& x = ts.m_pType[vCodes[i]];
+		BEAM_LOG_INFO() << "\t" << proto::TraficStats::get_MsgName(vCodes[i])
+			<< " In=" << x.m_In.m_Msgs << "/" << x.m_In.m_Bytes
+			<< " Out=" << x.m_Out.m_Msgs << "/" << x.m_Out.m_Bytes;
+	}
+
+	std::sort(vCodes.begin(), vCodes.end(), [&ts](uint8_t a, uint8_t b) { return ts.m_pType[a].m_Handle.m_Total_us > ts.m_pType[b].m_Handle.m_Total_us; });
+
+	BEAM_LOG_INFO() << "Handling time by message type:";
+	for (size_t i = 0; (i < vCodes.size()) && (i < s_Top); i++)
+	{
+		const auto& x = ts.m_pType[vCodes[i]];
+		uint64_t nCount = x.m_Handle.get_Count();
+		if (!nCount)
+			break;
+
+		uint64_t nDecode = x.m_Decode.get_Count();
+		uint64_t nQueue = x.m_Queue.get_Count();
+
+		BEAM_LOG_INFO() << "\t" << proto::TraficStats::get_MsgName(vCodes[i])
+			<< " Total_us=" << x.m_Handle.m_Total_us
+			<< " Avg_us=" << x.m_Handle.m_Total_us / nCount
+			<< " Max_us=" << x.m_Handle.m_Max_us
+			<< " Decode_avg_us=" << (nDecode ? (x.m_Decode.m_Total_us / nDecode) : 0)
+			<< " Queue_avg_us=" << (nQueue ? (x.m_Queue.m_Total_us / nQueue) : 0);
+	}
+
+	std::vector<PeerTrafic> vPeers;
+	n.get_PeersTrafic(vPeers);
+
+	std::sort(vPeers.begin(), vPeers.end(), [](const PeerTrafic& a, const PeerTrafic& b) {
+		return (a.m_Totals.m_In.m_Bytes + a.m_Totals.m_Out.m_Bytes) > (b.m_Totals.m_In.m_Bytes + b.m_Totals.m_Out.m_Bytes);
+	});
+
+	BEAM_LOG_INFO() << "Trafic by peer:";
+	for (size_t i = 0; (i < vPeers.size()) && (i < s_Top); i++)
+	{
+		const auto& x = vPeers[i];
+		BEAM_LOG_INFO() << "\t" << x.m_Addr
+			<< " In=" << x.m_Totals.m_In.m_Msgs << "/" << x.m_Totals.m_In.m_Bytes
+			<< " Out=" << x.m_Totals.m_Out.m_Msgs << "/" << x.m_Totals.m_Out.m_Bytes;
+	}
+
+	io::FragmentPool::Stats ps = io::FragmentPool::get_stats();
+	BEAM_LOG_INFO() << "Buffer pool: Allocs=" << ps.allocs << " Hits=" << ps.hits << " Frees=" << ps.frees << " Released=" << ps.released;
 }
 
 void Node::Peer::MaybeSendSerif()
@@ -4027,32 +4924,30 @@ void Node::Peer::OnMsg(proto::BbsMsg&& msg)
 	if (msg.m_TimePosted + Rules::get().DA.MaxAhead_s < m_This.m_Bbs.m_HighestPosted_s)
 		return; // don't allow too much out-of-order messages
 
-	NodeDB& db = m_This.m_Processor.get_DB();
-	NodeDB::WalkerBbs wlk;
+	BbsStore& st = m_This.m_Bbs.m_Store;
+	BbsStore::Data d;
 
-	wlk.m_Data.m_Channel = msg.m_Channel;
-	wlk.m_Data.m_TimePosted = msg.m_TimePosted;
-	wlk.m_Data.m_Message = Blob(msg.m_Message);
-	msg.m_Nonce.Export(wlk.m_Data.m_Nonce);
+	d.m_Channel = msg.m_Channel;
+	d.m_TimePosted = msg.m_TimePosted;
+	d.m_Message = Blob(msg.m_Message);
+	msg.m_Nonce.Export(d.m_Nonce);
 
-	Bbs::CalcMsgKey(wlk.m_Data);
+	Bbs::CalcMsgKey(d);
 
-	if (db.BbsFind(wlk.m_Data.m_Key))
+	if (st.Find(d.m_Key))
 		return; // already have it
 
 	m_This.m_Bbs.MaybeCleanup();
 
-	uint64_t id = db.BbsIns(wlk.m_Data);
-	m_This.m_Bbs.m_W.Delete(wlk.m_Data.m_Key);
+	uint64_t id = st.Insert(d);
+	m_This.m_Bbs.m_W.Delete(d.m_Key);
 
 	std::setmax(m_This.m_Bbs.m_HighestPosted_s, msg.m_TimePosted);
-	m_This.m_Bbs.m_Totals.m_Count++;
-	m_This.m_Bbs.m_Totals.m_Size += wlk.m_Data.m_Message.n;
 
 	// 1. Send to other BBS-es
 
 	proto::BbsHaveMsg msgOut;
-	msgOut.m_Key = wlk.m_Data.m_Key;
+	msgOut.m_Key = d.m_Key;
 
 	for (PeerList::iterator it = m_This.m_lstPeers.begin(); m_This.m_lstPeers.end() != it; ++it)
 	{
@@ -4063,7 +4958,8 @@ void Node::Peer::OnMsg(proto::BbsMsg&& msg)
 		if (!(peer.m_LoginFlags & proto::LoginFlags::Bbs) || peer.IsChocking())
 			continue;
 
-		peer.Send(msgOut);
+		if (!peer.ReconAdd(proto::Recon::Type::Bbs, msgOut.m_Key))
+			peer.Send(msgOut);
 	}
 
 	// 2. Send to subscribed
@@ -4080,7 +4976,7 @@ void Node::Peer::OnMsg(proto::BbsMsg&& msg)
 		if (s.m_pPeer->IsChocking())
 			continue;
 
-		s.m_pPeer->SendBbsMsg(wlk.m_Data);
+		s.m_pPeer->SendBbsMsg(d);
 		s.m_Cursor = id;
 
 		s.m_pPeer->IsChocking(); // in case it's chocking - for faster recovery recheck it ASAP
@@ -4092,8 +4988,7 @@ void Node::Peer::OnMsg(proto::BbsHaveMsg&& msg)
 	if (!m_This.m_Cfg.m_Bbs.IsEnabled())
 		ThrowUnexpected();
 
-	NodeDB& db = m_This.m_Processor.get_DB();
-	if (db.BbsFind(msg.m_Key)) {
+	if (m_This.m_Bbs.m_Store.Find(msg.m_Key)) {
 		// stupid compiler insists on parentheses here!
 		return; // already have it
 	}
@@ -4113,14 +5008,16 @@ void Node::Peer::OnMsg(proto::BbsGetMsg&& msg)
 	if (!m_This.m_Cfg.m_Bbs.IsEnabled())
 		ThrowUnexpected();
 
-	NodeDB& db = m_This.m_Processor.get_DB();
-	NodeDB::WalkerBbs wlk;
-
-	wlk.m_Data.m_Key = msg.m_Key;
-	if (!db.BbsFind(wlk))
+	BbsStore& st = m_This.m_Bbs.m_Store;
+	const BbsStore::Msg* pMsg = st.Find(msg.m_Key);
+	if (!pMsg)
 		return; // don't have it
 
-	SendBbsMsg(wlk.m_Data);
+	BbsStore::Data d;
+	ByteBuffer buf;
+	st.Read(*pMsg, d, buf);
+
+	SendBbsMsg(d);
 }
 
 void Node::Peer::SendBbsMsg(const NodeDB::WalkerBbs::Data& d)
@@ -4155,7 +5052,7 @@ void Node::Peer::OnMsg(proto::BbsSubscribe&& msg)
 		m_This.m_Bbs.m_Subscribed.insert(pS->m_Bbs);
 		m_Subscriptions.insert(pS->m_Peer);
 
-		pS->m_Cursor = m_This.m_Processor.get_DB().BbsFindCursor(msg.m_TimeFrom) - 1;
+		pS->m_Cursor = m_This.m_Bbs.m_Store.FindCursor(msg.m_TimeFrom) - 1;
 
 		BroadcastBbs(*pS);
 	}
@@ -4168,20 +5065,17 @@ void Node::Peer::BroadcastBbs(Bbs::Subscription& s)
 	if (IsChocking())
 		return;
 
-	NodeDB& db = m_This.m_Processor.get_DB();
-	NodeDB::WalkerBbs wlk;
-
-	wlk.m_Data.m_Channel = s.m_Peer.m_Channel;
-	wlk.m_ID = s.m_Cursor;
+	BbsStore& st = m_This.m_Bbs.m_Store;
+	BbsStore::Data d;
+	ByteBuffer buf;
 
-	for (db.EnumBbsCSeq(wlk); wlk.MoveNext(); )
+	for (const BbsStore::Msg* pMsg; (pMsg = st.get_NextInChannel(s.m_Peer.m_Channel, s.m_Cursor)); )
 	{
-		SendBbsMsg(wlk.m_Data);
+		st.Read(*pMsg, d, buf);
+		SendBbsMsg(d);
 		if (IsChocking())
 			break;
 	}
-
-	s.m_Cursor = wlk.m_ID;
 }
 
 void Node::Peer::OnMsg(proto::BbsResetSync&& msg)
@@ -4189,7 +5083,7 @@ void Node::Peer::OnMsg(proto::BbsResetSync&& msg)
 	if (!m_This.m_Cfg.m_Bbs.IsEnabled())
 		ThrowUnexpected();
 
-	m_CursorBbs = m_This.m_Processor.get_DB().BbsFindCursor(msg.m_TimeFrom) - 1;
+	m_CursorBbs = m_This.m_Bbs.m_Store.FindCursor(msg.m_TimeFrom) - 1;
 	BroadcastBbs();
 }
 
@@ -5530,6 +6424,23 @@ bool Node::GenerateRecoveryInfo(const char* szPath)
 	return true;
 }
 
+bool Node::GenerateSnapshot(const char* szPath)
+{
+	if (!m_Processor.BuildCwp())
+		return false; // no info yet
+
+	try
+	{
+		return m_Processor.ExportSnapshot(szPath, m_Processor.m_Cwp);
+	}
+	catch (const std::exception& ex)
+	{
+		BEAM_LOG_ERROR() << ex.what();
+	}
+
+	return false;
+}
+
 void Node::PrintTxos()
 {
 	for (const auto& acc : m_Processor.m_vAccounts)
@@ -6488,12 +7399,15 @@ void Node::Validator::Sign(ECC::Signature& sig, const Merkle::Hash& hv)
 template <typename TMsg>
 void Node::Validator::Broadcast(const TMsg& msg, const Peer* pSrc) const
 {
+	proto::NodeConnection::Broadcast bc;
+	bc.Set(msg);
+
 	auto& n = get_ParentObj();
 	for (PeerList::iterator it = n.m_lstPeers.begin(); n.m_lstPeers.end() != it; ++it)
 	{
 		Peer& peer = *it;
 		if ((&peer != pSrc) && ShouldSendTo(peer))
-			peer.Send(msg);
+			peer.Send(bc);
 	}
 }
 
@@ -15,6 +15,7 @@
 #pragma once
 
 #include "processor.h"
+#include "bbs_store.h"
 #include "utility/io/timer.h"
 #include "core/proto.h"
 #include "core/block_crypt.h"
@@ -60,10 +61,13 @@ struct Node
 
 		std::string m_sPathLocal;
 		NodeProcessor::Horizon m_Horizon;
+		NodeProcessor::ImageCheckpoints m_ImageCheckpoints;
+		NodeProcessor::SyncChunks m_SyncChunks;
 
 		struct Timeout {
 			uint32_t m_GetState_ms	= 1000 * 5;
 			uint32_t m_GetBlock_ms	= 1000 * 30;
+			uint32_t m_SyncChunkStraggler_ms = 1000 * 7; // the lowest sync chunk is requested from an idle peer as well, if pending longer than this
 			uint32_t m_GetTx_ms		= 1000 * 5;
 			uint32_t m_GetBbsMsg_ms	= 1000 * 10;
 			uint32_t m_MiningSoftRestart_ms = 1000;
@@ -81,6 +85,7 @@ struct Node
 		bool m_LogTxStem = true;
 		bool m_LogTxFluff = true;
 		bool m_LogTraficUsage = false;
+		uint32_t m_LogTraficStats_ms = 0; // periodically log the summary of the traffic per message type and peer. 0 = disabled
 
 		bool m_PreferOnlineMining = true;
 
@@ -89,6 +94,13 @@ struct Node
 		// negative: number of cores minus number of mining threads.
 		int m_VerificationThreads = 0;
 
+		// Number of threads for decoding (decryption, MAC verification, deserialization) of the incoming peers traffic.
+		// 0: decoded on the reactor thread
+		uint32_t m_DecoderThreads = 0;
+
+		// Announce new blocks to (and accept from) the peers that support it as compact blocks, reconstructed from the tx pool
+		bool m_CompactBlocks = false;
+
 		struct RollbackLimit
 		{
 			uint32_t m_Max = 60; // artificial restriction on how much the node will rollback automatically
@@ -108,8 +120,9 @@ struct Node
 			{
 				// set the following to 0 to disable BBS replication.
 				// Typically each transaction demands several messages, there're roughly max ~1K txs per block, and 1 block per minute.
-				// Means, for the default 12-hour lifetime it's about 1.5 mln, hence the following (20 mln) is more than enough
-				m_Limit.m_Count = 20000000;
+				// Means, for the default 12-hour lifetime it's about 1.5 mln, hence the following (2 mln) should be enough.
+				// Note: the message index is kept in memory, ~110 bytes per message, i.e. up to ~220MB for this limit
+				m_Limit.m_Count = 2000000;
 				// max bbs msg size is proto::Bbs::s_MaxMsgSize == 1Mb. However mostly they're much smaller.
 				m_Limit.m_Size = uint64_t(5) * 1024U * 1024U * 1024U; // 5Gb
 			}
@@ -118,6 +131,14 @@ struct Node
 
 		} m_Bbs;
 
+		struct Compact
+		{
+			// online DB compaction, runs in short slices between other events. Set m_Slice_ms to 0 to disable
+			uint32_t m_Slice_ms = 20;
+			uint32_t m_Idle_ms = 1000 * 30; // check interval when there's nothing to compact
+
+		} m_Compact;
+
 		struct BandwidthCtl
 		{
 			size_t m_Chocking = 1024 * 1024;
@@ -126,12 +147,15 @@ struct Node
 			size_t m_MaxBodyPackSize = 1024 * 1024 * 5;
 			uint32_t m_MaxBodyPackCount = 3000;
 
+			uint32_t m_MaxPipeline = 4; // max sync requests in flight per peer, adjusted w.r.t. its latency and bandwidth
+
 		} m_BandwidthCtl;
 
 		struct TestMode {
 			// for testing only!
 			uint32_t m_FakePowSolveTime_ms = 0;
 			uint32_t m_TimeDrift_ms = 0;
+			bool m_StallBodyPacks = false; // don't respond to multi-block requests
 
 		} m_TestMode;
 
@@ -152,6 +176,17 @@ struct Node
 
 		} m_Dandelion;
 
+		struct Recon
+		{
+			// Announce txs and bbs msgs via periodic set reconciliation, for peers that support it. Set to 0 to disable
+			uint32_t m_Period_ms = 0;
+			uint32_t m_PendingMax = 4096; // if exceeded - announce the rest in a standard way
+			uint32_t m_RoundTimeout = 3; // in periods, after which the pending announcements are flushed in a standard way
+
+			bool IsEnabled() const { return m_Period_ms > 0; }
+
+		} m_Recon;
+
 		struct Recovery
 		{
 			std::string m_sPathOutput; // directory with (back)slash and optionally a common prefix
@@ -220,6 +255,35 @@ struct Node
 
 	} m_SyncStatus;
 
+	struct PeerTrafic
+	{
+		io::Address m_Addr;
+		proto::TraficStats::Totals m_Totals;
+	};
+
+	// Per-peer request pipelining. The num of requests in flight is chosen to cover the round-trip, w.r.t. the typical response size
+	struct Pipeline
+	{
+		uint32_t m_Rtt_ms = 0; // smoothed, measured on requests sent to an idle peer. 0 if not measured yet
+		size_t m_SizeAvg = 0; // smoothed response size
+		uint32_t m_Window = 1;
+		uint32_t m_Done_ms = 0; // last response time, or the 1st request time if was idle
+
+		uint32_t get_Start_ms(uint32_t tAssigned_ms, bool& bIdle) const; // if the previous request was still in flight - this one could only be served after it
+		void OnResponse(size_t nSize, uint32_t dt_ms, bool bIdle, uint32_t nBps0, uint32_t nBpsAvg, uint32_t nMax); // nSize == 0: data missing
+		void Update(uint32_t nBps, uint32_t nMax);
+	};
+
+	struct CompactStats
+	{
+		uint32_t m_Built = 0; // own new tips announced as compact blocks
+		uint32_t m_Reconstructed = 0; // compact blocks received and accepted without downloading the body
+	};
+
+	const proto::TraficStats& get_TraficStats() const { return m_TraficStats; } // per message type, since start
+	const CompactStats& get_CompactStats() const { return m_CompactRelay.m_Stats; }
+	void get_PeersTrafic(std::vector<PeerTrafic>&) const; // connected peers, since connected
+
 	uint32_t get_AcessiblePeerCount() const; // all the peers with known addresses. Including temporarily banned
 	const PeerManager::AddrSet& get_AcessiblePeerAddrs() const;
 
@@ -227,6 +291,7 @@ struct Node
 	bool m_PostStartSynced = false;
 
 	bool GenerateRecoveryInfo(const char*);
+	bool GenerateSnapshot(const char*);
 	void PrintTxos();
 	void PrintRollbackStats();
 
@@ -289,6 +354,10 @@ private:
 		void OnFlushTimer();
 		void FlushDB();
 
+		io::Timer::Ptr m_pCompactTimer;
+		void StartCompactTimer(uint32_t timeout_ms);
+		void OnCompactTimer();
+
 		bool m_bGoUpPending = false;
 		io::Timer::Ptr m_pGoUpTimer;
 		void TryGoUpAsync();
@@ -327,6 +396,7 @@ private:
 
 	uint32_t m_nTasksPackHdr = 0;
 	uint32_t m_nTasksPackBody = 0;
+	uint32_t m_nTasksBodyMulti = 0; // body packs (sync chunks) in flight
 
 	TaskList m_lstTasksUnassigned;
 	TaskSet m_setTasks;
@@ -337,6 +407,7 @@ private:
 	void TryAssignTask(Task&);
 	bool TryAssignTask(Task&, Peer&);
 	void DeleteUnassignedTask(Task&);
+	void TryReassignStraggler(Peer& pIdle);
 
 	void InitKeys();
 	void InitIDs();
@@ -447,6 +518,8 @@ private:
 
 		static void CalcMsgKey(NodeDB::WalkerBbs::Data&);
 		uint32_t m_LastCleanup_ms = 0;
+		void Initialize();
+		void ImportFromDB();
 		void Cleanup();
 		void MaybeCleanup();
 		bool IsInLimits() const;
@@ -475,11 +548,67 @@ private:
 		Subscription::BbsSet m_Subscribed;
 		Timestamp m_HighestPosted_s = 0;
 
-		NodeDB::BbsTotals m_Totals;
+		BbsStore m_Store;
 
 		IMPLEMENT_GET_PARENT_OBJ(Node, m_Bbs)
 	} m_Bbs;
 
+	struct Recon
+	{
+		io::Timer::Ptr m_pTimer;
+
+		void Initialize();
+		void OnTimer();
+
+		IMPLEMENT_GET_PARENT_OBJ(Node, m_Recon)
+	} m_Recon;
+
+	struct CompactRelay
+	{
+		// short IDs of the known elements
+		struct Known
+		{
+			std::map<uint64_t, const Input*> m_Inputs;
+			std::map<uint64_t, const Output*> m_Outputs;
+			std::map<uint64_t, const TxKernel*> m_Kernels;
+
+			void Add(const TxVectors::Full&, uint64_t nSalt);
+			void Add(const TxPool::Fluff&, uint64_t nSalt, bool bFluffedOnly);
+		};
+
+		// announcement of the current tip, and its body to serve the missing elements
+		proto::CompactBlock m_Msg;
+		Block::Body m_Body;
+		bool m_Valid = false;
+
+		bool m_Built = false; // for the current tip, successfully or not
+		CompactStats m_Stats;
+
+		void Reset(); // new tip
+		void Build(); // on demand, before the txs of the new block are removed from the pool
+		bool IsEnabled() const;
+
+		bool Decode(Block::Body&, proto::CompactBlock&, proto::GetCompactMissing&) const; // returns false if malformed
+		bool Fetch(proto::CompactMissing&, const proto::GetCompactMissing&) const;
+		static bool Fill(Block::Body&, proto::CompactMissing&);
+
+		static void Clone(Input::Ptr&, const Input&);
+		static void Clone(Output::Ptr&, const Output&);
+		static void Clone(TxKernel::Ptr&, const TxKernel&);
+
+	private:
+		template <typename TPtr, typename TMap>
+		static void Encode(std::vector<uint64_t>& vIDs, std::vector<TPtr>& vPrefilled, const std::vector<TPtr>&, const TMap& mapKnown, uint64_t nSalt);
+		template <typename TPtr, typename TMap>
+		static bool Decode(std::vector<TPtr>&, std::vector<uint32_t>& vMissing, const std::vector<uint64_t>& vIDs, std::vector<TPtr>& vPrefilled, const TMap& mapKnown);
+		template <typename TPtr>
+		static bool Fetch(std::vector<TPtr>&, const std::vector<TPtr>&, const std::vector<uint32_t>& vIdx);
+		template <typename TPtr>
+		static bool Fill(std::vector<TPtr>&, std::vector<TPtr>& vMissing);
+
+		IMPLEMENT_GET_PARENT_OBJ(Node, m_CompactRelay)
+	} m_CompactRelay;
+
 	struct PeerMan
 		:public PeerManager
 	{
@@ -570,11 +699,40 @@ private:
 
 		const NodeProcessor::Account* m_pAccount = nullptr;
 
+		proto::TraficStats::Totals m_Trafic;
+
 		TaskList m_lstTasks;
 		std::set<std::pair<Task::Key, uint64_t> > m_setRejected; // data that shouldn't be requested from this peer. Reset after reconnection or on receiving NewTip
 
 		Bbs::Subscription::PeerSet m_Subscriptions;
 
+		struct Recon
+		{
+			typedef proto::Recon::Key Key;
+
+			struct Set
+			{
+				std::set<Key> m_Pending; // to be reconciled in the next round
+				std::map<uint64_t, Key> m_Sent; // sketched in the current round (initiator only)
+				uint64_t m_Salt = 0;
+				uint32_t m_DiffEst = 0; // adjusted wrt decode failures
+				uint32_t m_Ticks = 0; // since the round started, 0 if no round is in progress
+				uint32_t m_Wait = 0; // since pending keys are waiting for a round (responder, or chocking initiator)
+			};
+
+			Set m_pSet[proto::Recon::Type::count];
+
+		} m_Recon;
+
+		struct CompactRelay
+		{
+			proto::CompactBlock m_Msg; // awaiting the missing elements
+			Block::Body m_Body; // partially reconstructed
+			bool m_Pending = false;
+		} m_CompactRelay;
+
+		Pipeline m_Pipeline;
+
 		io::Timer::Ptr m_pTimerRequest;
 		io::Timer::Ptr m_pTimerPeers;
 
@@ -593,6 +751,13 @@ private:
 		void BroadcastTxs();
 		void BroadcastBbs();
 		void BroadcastBbs(Bbs::Subscription&);
+		static uint32_t get_ReconLoginFlag(uint8_t nType);
+		bool IsReconActive(uint8_t nType) const;
+		bool ReconAdd(uint8_t nType, const Recon::Key&); // returns false if the key should be announced in a standard way
+		void ReconSendHave(uint8_t nType, const Recon::Key&);
+		void ReconFlush(uint8_t nType);
+		void ReconOnTimer();
+		void ReconStart(uint8_t nType);
 		void MaybeSendSerif();
 		void MaybeSendDependent();
 		void OnChocking();
@@ -609,7 +774,9 @@ private:
 		void ModifyRatingWrtData(size_t nSize);
 		void SendHdrs(NodeDB::StateID&, uint32_t nCount);
 		void SendTx(Transaction::Ptr& ptx, bool bFluff, const Merkle::Hash* pCtx = nullptr);
+		void OnTip(const Block::SystemState::Full&);
 		void OnNewTip2();
+		void OnCompactBlock(proto::CompactBlock&, Block::Body&);
 		void PbftSendStamp();
 
 		struct ISelector {
@@ -639,6 +806,9 @@ private:
 		void OnMsg(proto::Bye&&) override;
 		void OnMsg(proto::Pong&&) override;
 		void OnMsg(proto::NewTip&&) override;
+		void OnMsg(proto::CompactBlock&&) override;
+		void OnMsg(proto::GetCompactMissing&&) override;
+		void OnMsg(proto::CompactMissing&&) override;
 		void OnMsg(proto::DataMissing&&) override;
 		void OnMsg(proto::GetHdr&&) override;
 		void OnMsg(proto::GetHdrPack&&) override;
@@ -670,6 +840,8 @@ private:
 		void OnMsg(proto::BbsGetMsg&&) override;
 		void OnMsg(proto::BbsSubscribe&&) override;
 		void OnMsg(proto::BbsResetSync&&) override;
+		void OnMsg(proto::ReconSketch&&) override;
+		void OnMsg(proto::ReconRequest&&) override;
 		void OnMsg(proto::GetEvents&&) override;
 		void OnMsg(proto::BlockFinalization&&) override;
 		void OnMsg(proto::GetStateSummary&&) override;
@@ -713,6 +885,21 @@ private:
 		IMPLEMENT_GET_PARENT_OBJ(Node, m_Server)
 	} m_Server;
 
+	proto::DecoderPool m_DecoderPool;
+	proto::TraficStats m_TraficStats;
+
+	struct TraficLog
+	{
+		static const uint32_t s_Top = 5; // num of entries in each category
+
+		io::Timer::Ptr m_pTimer;
+
+		void Initialize();
+		void OnTimer();
+
+		IMPLEMENT_GET_PARENT_OBJ(Node, m_TraficLog)
+	} m_TraficLog;
+
 	struct Beacon
 	{
 		struct OutCtx;
@@ -170,9 +170,18 @@ void NodeProcessor::Initialize(const char* szPath, const StartParams& sp, ILongA
 	m_Mmr.m_Shielded.m_Count = m_DB.ParamIntGetDef(NodeDB::ParamID::ShieldedInputs);
 	m_Mmr.m_Shielded.m_Count += m_Extra.m_ShieldedOutputs;
 
+	bool bSnapshot = !sp.m_sSnapshot.empty() && ImportSnapshot(sp.m_sSnapshot.c_str());
+
 	InitializeMapped(szPath);
 	m_Extra.m_Txos = get_TxosBefore(Block::Number(m_Cursor.m_Full.m_Number.v + 1));
 
+	if (bSnapshot && !TestSnapshot())
+	{
+		RollbackDB();
+		m_Mapped.Close();
+		throw std::runtime_error("Snapshot verification failed");
+	}
+
 	bool bRebuildNonStd = false;
 	if ((StartParams::RichInfo::Off | StartParams::RichInfo::On) & sp.m_RichInfoFlags)
 	{
@@ -206,7 +215,7 @@ void NodeProcessor::Initialize(const char* szPath, const StartParams& sp, ILongA
 
 	m_Horizon.Normalize();
 
-	if (PruneOld() && !sp.m_Vacuum)
+	if (PruneOld() && !sp.m_Vacuum && !m_DB.IsVacuumIncremental())
 	{
 		BEAM_LOG_INFO() << "Old data was just removed from the DB. Some space can be freed by vacuum";
 	}
@@ -309,6 +318,11 @@ void NodeProcessor::InitializeMapped(const char* sz)
 		InitMapping(sz, true);
 	}
 
+	RebuildMapped();
+}
+
+void NodeProcessor::RebuildMapped()
+{
 	InitializeUtxos();
 
 	NodeDB::WalkerContractData wlk;
@@ -337,6 +351,551 @@ bool NodeProcessor::TestDefinition()
 	return m_Cursor.m_Full.m_Definition == hv;
 }
 
+struct NodeProcessor::KrnFlyMmr
+	:public Merkle::FlyMmr
+{
+	const TxVectors::Eternal& m_Txve;
+
+	KrnFlyMmr(const TxVectors::Eternal& txve)
+		:m_Txve(txve)
+	{
+		m_Count = txve.m_vKernels.size();
+	}
+
+	void LoadElement(Merkle::Hash& hv, uint64_t n) const override {
+		assert(n < m_Count);
+		hv = m_Txve.m_vKernels[n]->get_ID();
+	}
+};
+
+struct NodeProcessor::Snapshot
+{
+	static const uint32_t s_Version = 2;
+
+	typedef yas::binary_oarchive<std::FStream, SERIALIZE_OPTIONS> Ser;
+	typedef yas::binary_iarchive<std::FStream, SERIALIZE_OPTIONS> Der;
+
+	static Height get_KrnHeightMin(Height hTip)
+	{
+		// kernels (and blocks) that may still be referenced by the consequent blocks
+		const Rules& r = Rules::get();
+		if (r.IsPastFork_<2>(hTip) && (hTip > r.MaxKernelValidityDH))
+			return hTip - r.MaxKernelValidityDH;
+		return 0;
+	}
+
+	static bool MoveNext(Der& der)
+	{
+		bool bMore = false;
+		der & bMore;
+		return bMore;
+	}
+
+	static void ThrowRulesMismatch() {
+		throw std::runtime_error("Snapshot rules mismatch");
+	}
+
+	static void ThrowBadData() {
+		throw std::runtime_error("Snapshot data inconsistent");
+	}
+
+	// Definition of a past state, from its eternal body and the stored commitments
+	struct Evaluator
+		:public Block::SystemState::Evaluator
+	{
+		Merkle::Hash m_hvHistory;
+		Merkle::Hash m_hvKernels;
+		const StateExtra::Comms* m_pComms;
+
+		bool get_History(Merkle::Hash& hv) override { hv = m_hvHistory; return true; }
+		bool get_Kernels(Merkle::Hash& hv) override { hv = m_hvKernels; return true; }
+		bool get_Logs(Merkle::Hash& hv) override { hv = m_pComms->m_hvLogs; return true; }
+		bool get_CSA(Merkle::Hash& hv) override { hv = m_pComms->m_hvCSA; return true; }
+	};
+};
+
+bool NodeProcessor::ExportSnapshot(const char* sz, const Block::ChainWorkProof& cwp)
+{
+	const Rules& r = Rules::get();
+	if (!m_Cursor.m_Row || IsFastSync() || (Rules::Consensus::Pbft == r.m_Consensus))
+		return false;
+
+	std::FStream fs;
+	fs.Open(sz, false, true);
+	Snapshot::Ser ser(fs);
+
+	uint32_t nVer = Snapshot::s_Version;
+	ser & nVer;
+
+	uint32_t nForks = r.FindFork(m_Cursor.m_hh.m_Height) + 1;
+	ser & nForks;
+
+	for (uint32_t iFork = 0; iFork < nForks; iFork++)
+		ser & r.pForks[iFork].m_Hash;
+
+	ser & cwp;
+
+	ByteBuffer bufKey, bufVal;
+	m_DB.ParamGet(NodeDB::ParamID::Treasury, nullptr, nullptr, &bufVal);
+
+	ser
+		& m_Extra.m_TxosTreasury
+		& bufVal;
+
+	// headers, with eternal bodies (and their extra) of the recent blocks
+	const Height hKrnMin = Snapshot::get_KrnHeightMin(m_Cursor.m_hh.m_Height);
+
+	LongAction la("Exporting snapshot...", m_Cursor.m_Full.m_Number.v, m_pExternalHandler);
+
+	for (Block::Number num(1); num.v <= m_Cursor.m_Full.m_Number.v; num.v++)
+	{
+		uint64_t rowid = FindActiveAtStrict(num);
+
+		Block::SystemState::Full s;
+		m_DB.get_State(rowid, s);
+
+		bufVal.clear();
+		if (s.get_Height() >= hKrnMin)
+			m_DB.GetStateBlock(rowid, nullptr, &bufVal, nullptr);
+
+		ser
+			& s
+			& m_DB.get_StateTxos(rowid)
+			& bufVal;
+
+		if (!bufVal.empty())
+		{
+			StateExtra::Full se;
+			if (m_DB.get_StateExtra(rowid, &se, sizeof(se)) < sizeof(se))
+			{
+				BEAM_LOG_WARNING() << "Snapshot: no extra for state " << num.v;
+				return false;
+			}
+
+			ser
+				& se.m_TotalOffset
+				& se.m_hvCSA
+				& se.m_hvLogs;
+		}
+
+		la.OnProgress(num.v);
+	}
+
+	// kernels are not exported, they're rebuilt from the bodies
+	const bool bMore = true, bEnd = false;
+
+	{
+		// all the unspent, plus the whole treasury
+		NodeDB::WalkerTxo wlk;
+		for (m_DB.EnumTxos(wlk, 0); wlk.MoveNext(); )
+		{
+			if ((MaxHeight != wlk.m_SpendHeight) && (wlk.m_ID >= m_Extra.m_TxosTreasury))
+				continue;
+
+			wlk.m_Value.Export(bufVal);
+			ser & bMore & wlk.m_ID & bufVal & wlk.m_SpendHeight;
+		}
+		ser & bEnd;
+	}
+
+	{
+		NodeDB::WalkerContractData wlk;
+		for (m_DB.ContractDataEnum(wlk); wlk.MoveNext(); )
+		{
+			wlk.m_Key.Export(bufKey);
+			wlk.m_Val.Export(bufVal);
+			ser & bMore & bufKey & bufVal;
+		}
+		ser & bEnd;
+	}
+
+	{
+		// shielded in/outs, foreign emissions. The shielded data is derived from it on import
+		NodeDB::WalkerUnique wlk;
+		for (m_DB.UniqueEnum(wlk); wlk.MoveNext(); )
+		{
+			wlk.m_Key.Export(bufKey);
+			wlk.m_Val.Export(bufVal);
+			ser & bMore & bufKey & bufVal;
+		}
+		ser & bEnd;
+	}
+
+	{
+		Asset::Full ai;
+		for (ai.m_ID = r.CA.ForeignEnd; m_DB.AssetGetNext(ai); )
+			ser & bMore & ai;
+		ser & bEnd;
+	}
+
+	fs.Flush();
+	return true;
+}
+
+bool NodeProcessor::ImportSnapshot(const char* sz)
+{
+	const Rules& r = Rules::get();
+	if (m_Cursor.m_Row || IsFastSync() || ((r.TreasuryChecksum != Zero) && IsTreasuryHandled()))
+	{
+		BEAM_LOG_WARNING() << "Node is not empty, snapshot ignored";
+		return false;
+	}
+
+	if (Rules::Consensus::Pbft == r.m_Consensus)
+		throw std::runtime_error("Snapshot is not supported for this consensus");
+
+	BEAM_LOG_INFO() << "Importing snapshot " << sz;
+
+	std::FStream fs;
+	fs.Open(sz, true, true);
+	Snapshot::Der der(fs);
+
+	uint32_t nVer = 0;
+	der & nVer;
+	if (Snapshot::s_Version != nVer)
+		Snapshot::ThrowRulesMismatch();
+
+	uint32_t nForks = 0;
+	der & nForks;
+	if (!nForks || (nForks > _countof(r.pForks)))
+		Snapshot::ThrowRulesMismatch();
+
+	for (uint32_t iFork = 0; iFork < nForks; iFork++)
+	{
+		ECC::Hash::Value hv;
+		der & hv;
+
+		if (hv != r.pForks[iFork].m_Hash)
+			Snapshot::ThrowRulesMismatch();
+	}
+
+	Block::ChainWorkProof cwp;
+	der & cwp;
+
+	Block::SystemState::Full sTip;
+	if (!cwp.IsValid(&sTip))
+		Snapshot::ThrowBadData();
+
+	if ((nForks < _countof(r.pForks)) && (sTip.get_Height() >= r.pForks[nForks].m_Height))
+		Snapshot::ThrowRulesMismatch();
+
+	ByteBuffer bufKey, bufVal;
+	TxoID nTxosTreasury = 0;
+
+	der
+		& nTxosTreasury
+		& bufVal;
+
+	if (r.TreasuryChecksum != Zero)
+	{
+		ECC::Hash::Value hv;
+		ECC::Hash::Processor()
+			<< Blob(bufVal)
+			>> hv;
+
+		if ((r.TreasuryChecksum != hv) || !nTxosTreasury)
+			Snapshot::ThrowBadData();
+
+		m_Extra.m_TxosTreasury = nTxosTreasury;
+
+		Blob blob(bufVal);
+		m_DB.ParamSet(NodeDB::ParamID::Treasury, &m_Extra.m_TxosTreasury, &blob);
+	}
+
+	if (!sTip.m_Number.v)
+		Snapshot::ThrowBadData();
+
+	// headers. The whole chain is pinned by the tip via the states MMR, which is the part of its Definition
+	const uint64_t nTotal = fs.get_Remaining();
+	LongAction la("Importing snapshot...", nTotal, m_pExternalHandler);
+
+	const Height hKrnMin = Snapshot::get_KrnHeightMin(sTip.get_Height());
+
+	Block::SystemState::Full s, sPrev;
+	Merkle::Hash hvLast;
+	TxoID nTxos = m_Extra.m_TxosTreasury;
+	NodeDB::StateID sid;
+	StateExtra::Full se;
+
+	for (Block::Number num(1); num.v <= sTip.m_Number.v; num.v++)
+	{
+		TxoID nTxosNext = 0;
+		der & s & nTxosNext & bufVal;
+
+		if ((s.m_Number.v != num.v) || !s.IsSane() || (nTxosNext < nTxos))
+			Snapshot::ThrowBadData();
+
+		if ((num.v > 1) && !sPrev.IsNext(s))
+			Snapshot::ThrowBadData();
+
+		if (bufVal.empty() == (s.get_Height() >= hKrnMin))
+			Snapshot::ThrowBadData(); // bodies are mandatory since hKrnMin (incl. the tip), older are not expected
+
+		Block::SystemState::ID id;
+		s.get_ID(id);
+
+		sid.m_Number = num;
+		sid.m_Row = m_DB.StateFindSafe(id);
+		if (!sid.m_Row)
+			sid.m_Row = m_DB.InsertState(s, Zero);
+
+		if (num.v > 1)
+			m_Mmr.m_States.Append(s.m_Prev);
+
+		if (bufVal.empty())
+			m_DB.set_StateTxosAndExtra(sid.m_Row, &nTxosNext, nullptr, nullptr);
+		else
+		{
+			der
+				& se.m_TotalOffset
+				& se.m_hvCSA
+				& se.m_hvLogs;
+
+			TxVectors::Eternal txve;
+			Deserializer derBody;
+			derBody.reset(bufVal);
+			derBody & txve;
+
+			Snapshot::Evaluator ev;
+			ev.m_Height = s.get_Height();
+			ev.m_pComms = &se;
+
+			KrnFlyMmr fmmr(txve);
+			fmmr.get_Hash(ev.m_hvKernels);
+
+			// the body must match the header commitments. The tip Definition is verified after import
+			if (r.IsPastFork_<3>(ev.m_Height))
+			{
+				if (num.v != sTip.m_Number.v)
+				{
+					m_Mmr.m_States.get_Hash(ev.m_hvHistory);
+
+					Merkle::Hash hvDef;
+					ev.get_Definition(hvDef);
+					if (s.m_Definition != hvDef)
+						Snapshot::ThrowBadData();
+				}
+			}
+			else
+			{
+				if (s.m_Kernels != ev.m_hvKernels)
+					Snapshot::ThrowBadData();
+			}
+
+			m_DB.SetStateBlock(sid.m_Row, Blob(nullptr, 0), bufVal, Zero);
+
+			Blob blobExtra(&se, sizeof(se));
+			m_DB.set_StateTxosAndExtra(sid.m_Row, &nTxosNext, &blobExtra, nullptr);
+
+			for (const auto& pKrn : txve.m_vKernels)
+				m_DB.InsertKernel(pKrn->get_ID(), ev.m_Height);
+		}
+
+		m_DB.SetStateFunctional(sid.m_Row);
+		m_DB.MoveFwd(sid);
+
+		nTxos = nTxosNext;
+		sPrev = s;
+		hvLast = id.m_Hash;
+
+		la.OnProgress(nTotal - fs.get_Remaining());
+	}
+
+	Merkle::Hash hvTip;
+	sTip.get_Hash(hvTip);
+	if (hvTip != hvLast)
+		Snapshot::ThrowBadData();
+
+	for (TxoID id0 = 0; Snapshot::MoveNext(der); )
+	{
+		TxoID id = 0;
+		Height hSpent = MaxHeight;
+		der & id & bufVal & hSpent;
+
+		if ((id < id0) || (id >= nTxos) || (bufVal.size() < s_TxoNakedMin))
+			Snapshot::ThrowBadData();
+		id0 = id + 1;
+
+		m_DB.TxoAdd(id, bufVal);
+		if (MaxHeight != hSpent)
+			m_DB.TxoSetSpent(id, hSpent);
+
+		la.OnProgress(nTotal - fs.get_Remaining());
+	}
+
+	while (Snapshot::MoveNext(der))
+	{
+		der & bufKey & bufVal;
+		m_DB.ContractDataInsert(bufKey, bufVal);
+	}
+
+	// shielded elements, ordered by their position in MMR
+	std::vector<std::pair<TxoID, Merkle::Hash> > vMmr;
+	std::vector<ShieldedTxo::DescriptionOutp> vOuts;
+	TxoID nShieldedIns = 0;
+
+	while (Snapshot::MoveNext(der))
+	{
+		der & bufKey & bufVal;
+
+		Blob blobVal(bufVal);
+		if (!m_DB.UniqueInsertSafe(bufKey, &blobVal))
+			Snapshot::ThrowBadData();
+
+		if (sizeof(ECC::Point) != bufKey.size())
+			continue;
+
+		const ECC::Point& key = *reinterpret_cast<const ECC::Point*>(&bufKey.front());
+		if (key.m_Y >= 4)
+			continue; // foreign emission
+
+		vMmr.emplace_back();
+		auto& x = vMmr.back();
+
+		if (key.m_Y & 2)
+		{
+			if (sizeof(ShieldedInpPacked) != bufVal.size())
+				Snapshot::ThrowBadData();
+			const auto& sip = *reinterpret_cast<const ShieldedInpPacked*>(&bufVal.front());
+
+			ShieldedTxo::DescriptionInp d;
+			d.m_SpendPk = key;
+			d.m_SpendPk.m_Y &= ~2;
+			sip.m_Height.Export(d.m_Height);
+			sip.m_MmrIndex.Export(x.first);
+
+			d.get_Hash(x.second);
+			nShieldedIns++;
+		}
+		else
+		{
+			if (sizeof(ShieldedOutpPacked) != bufVal.size())
+				Snapshot::ThrowBadData();
+			const auto& sop = *reinterpret_cast<const ShieldedOutpPacked*>(&bufVal.front());
+
+			vOuts.emplace_back();
+			ShieldedTxo::DescriptionOutp& d = vOuts.back();
+			d.m_SerialPub = key;
+			d.m_Commitment = sop.m_Commitment;
+			sop.m_TxoID.Export(d.m_ID);
+			sop.m_Height.Export(d.m_Height);
+			sop.m_MmrIndex.Export(x.first);
+
+			d.get_Hash(x.second);
+		}
+	}
+
+	std::sort(vMmr.begin(), vMmr.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+	for (size_t i = 0; i < vMmr.size(); i++)
+	{
+		if (vMmr[i].first != m_Mmr.m_Shielded.m_Count)
+			Snapshot::ThrowBadData();
+		m_Mmr.m_Shielded.Append(vMmr[i].second);
+	}
+
+	if (nShieldedIns)
+		m_DB.ParamIntSet(NodeDB::ParamID::ShieldedInputs, nShieldedIns);
+
+	// rebuild cmList and its state hashes
+	std::sort(vOuts.begin(), vOuts.end(), [](const auto& a, const auto& b) { return a.m_ID < b.m_ID; });
+
+	m_DB.ShieldedResize(vOuts.size(), 0);
+	m_DB.ShieldedStateResize(vOuts.size(), 0);
+
+	ECC::Hash::Value hvState = Zero;
+	for (size_t i = 0; i < vOuts.size(); i++)
+	{
+		const ShieldedTxo::DescriptionOutp& d = vOuts[i];
+		if (d.m_ID != i)
+			Snapshot::ThrowBadData();
+
+		ECC::Point::Native pt, pt2;
+		pt.Import(d.m_Commitment);
+		pt2.Import(d.m_SerialPub);
+		pt += pt2;
+
+		ECC::Point::Storage pt_s;
+		pt.Export(pt_s);
+
+		m_DB.ShieldedWrite(i, &pt_s, 1);
+
+		ShieldedTxo::UpdateState(hvState, pt_s);
+		m_DB.ShieldedStateWrite(i, &hvState, 1);
+
+		if (i + 1 < vOuts.size())
+		{
+			if (vOuts[i + 1].m_Height < d.m_Height)
+				Snapshot::ThrowBadData();
+			if (vOuts[i + 1].m_Height == d.m_Height)
+				continue;
+		}
+
+		m_DB.ShieldedOutpSet(d.m_Height, i + 1);
+	}
+
+	m_Extra.m_ShieldedOutputs = vOuts.size();
+
+	while (Snapshot::MoveNext(der))
+	{
+		Asset::Full ai;
+		der & ai;
+
+		Asset::ID aid = ai.m_ID;
+		if ((aid <= get_AidMax()) || (aid >= Asset::s_MaxCount))
+			Snapshot::ThrowBadData();
+
+		while (get_AidMax() + 1 < aid)
+			m_Mmr.m_Assets.Append(Zero); // gap
+
+		if (!m_DB.AssetAdd(ai) || (ai.m_ID != aid))
+			Snapshot::ThrowBadData();
+
+		Merkle::Hash hv;
+		ai.get_Hash(hv);
+		m_Mmr.m_Assets.Append(hv);
+	}
+
+	// no blocks and no txo info below the snapshot
+	m_Extra.m_Fossil = sTip.m_Number;
+	m_Extra.m_TxoLo = sTip.m_Number;
+	m_Extra.m_TxoHi = sTip.m_Number;
+
+	m_DB.ParamIntSet(NodeDB::ParamID::NumberFossil, m_Extra.m_Fossil.v);
+	m_DB.ParamIntSet(NodeDB::ParamID::NumberTxoLo, m_Extra.m_TxoLo.v);
+	m_DB.ParamIntSet(NodeDB::ParamID::NumberTxoHi, m_Extra.m_TxoHi.v);
+
+	m_DB.ParamDelSafe(NodeDB::ParamID::MappingStamp);
+
+	InitCursor(false, sid);
+
+	BEAM_LOG_INFO() << "Snapshot imported, tip " << m_Cursor.get_ID();
+	return true;
+}
+
+bool NodeProcessor::TestSnapshot()
+{
+	if (!TestDefinition())
+	{
+		BEAM_LOG_WARNING() << "Snapshot Definition mismatch";
+		return false;
+	}
+
+	if (Rules::get().IsPastFork_<3>(m_Cursor.m_hh.m_Height))
+	{
+		// Utxos are committed separately
+		Merkle::Hash hv;
+		m_Mapped.m_Utxo.get_Hash(hv);
+
+		if (m_Cursor.m_Full.m_Kernels != hv)
+		{
+			BEAM_LOG_WARNING() << "Snapshot Utxos mismatch";
+			return false;
+		}
+	}
+
+	return true;
+}
+
 
 // Ridiculous! Had to write this because strmpi isn't standard!
 int My_strcmpi(const char* sz1, const char* sz2)
@@ -373,7 +932,7 @@ void NodeProcessor::get_MappingPath(std::string& sPath, const char* sz)
 bool NodeProcessor::InitMapping(const char* sz, bool bForceReset)
 {
 	// derive mapping path from db path
-	std::string sPath;
+	std::string& sPath = m_sMappingPath;
 	get_MappingPath(sPath, sz);
 
 	Mapped::Stamp us;
@@ -475,13 +1034,183 @@ void NodeProcessor::Vacuum()
 	m_DbTx.Start(m_DB);
 }
 
+bool NodeProcessor::CompactStep(uint32_t nTimeout_ms)
+{
+	if (IsFastSync() || !m_DB.IsVacuumIncremental())
+		return false; // legacy DB needs a full vacuum once
+
+	const uint64_t nFreeMin = 0x100; // don't bother with less
+	const uint32_t nChunk = 0x40;
+
+	uint32_t t0_ms = GetTimeNnz_ms();
+
+	while (m_DB.get_FreePages() >= nFreeMin)
+	{
+		m_DB.VacuumIncremental(nChunk);
+
+		if (GetTimeNnz_ms() - t0_ms >= nTimeout_ms)
+			return true;
+	}
+
+	return false;
+}
+
 void NodeProcessor::CommitDB()
 {
 	if (m_DbTx.IsInProgress())
 	{
 		CommitMappingAndDB();
 		m_DbTx.Start(m_DB);
+
+		SaveImageCheckpoint();
+	}
+}
+
+void NodeProcessor::get_ImageCheckpointPath(std::string& sPath, uint32_t iSlot) const
+{
+	sPath = m_sMappingPath + ".ckpt" + std::to_string(iSlot);
+}
+
+void NodeProcessor::LoadImageCheckpoints(std::vector<ImageCheckpoint>& v)
+{
+	ByteBuffer buf;
+	m_DB.ParamGet(NodeDB::ParamID::ImageCheckpoints, nullptr, nullptr, &buf);
+
+	v.resize(buf.size() / sizeof(ImageCheckpoint));
+	if (!v.empty())
+		memcpy(&v.front(), &buf.front(), sizeof(ImageCheckpoint) * v.size());
+}
+
+bool NodeProcessor::IsImageCheckpointActive(const ImageCheckpoint& ic)
+{
+	if (!ic.m_Number.v || (ic.m_Number.v > m_Cursor.m_Full.m_Number.v))
+		return false;
+
+	Merkle::Hash hv;
+	m_DB.get_StateHash(FindActiveAtStrict(ic.m_Number), hv);
+	return hv == ic.m_Hash;
+}
+
+bool NodeProcessor::FindImageCheckpoint(ImageCheckpoint& ic, uint32_t& iSlot, Block::Number num)
+{
+	if (!m_ImageCheckpoints.m_Period || !m_Mapped.IsOpen())
+		return false;
+
+	std::vector<ImageCheckpoint> v;
+	LoadImageCheckpoints(v);
+
+	bool bFound = false;
+	for (uint32_t i = 0; i < v.size(); i++)
+	{
+		const auto& x = v[i];
+		if ((x.m_Number.v < num.v) || (x.m_Number.v + m_ImageCheckpoints.m_MinGap > m_Cursor.m_Full.m_Number.v))
+			continue;
+		if (bFound && (x.m_Number.v >= ic.m_Number.v))
+			continue;
+		if (!IsImageCheckpointActive(x))
+			continue;
+
+		ic = x;
+		iSlot = i;
+		bFound = true;
+	}
+
+	return bFound;
+}
+
+void NodeProcessor::RestoreImageCheckpoint(const ImageCheckpoint& ic, uint32_t iSlot)
+{
+	assert(!m_Mapped.IsOpen());
+
+	std::string sPath;
+	get_ImageCheckpointPath(sPath, iSlot);
+
+	bool bOk = false;
+	try
+	{
+		MappedFileRaw::Clone(m_sMappingPath.c_str(), sPath.c_str());
+		bOk = m_Mapped.Open(m_sMappingPath.c_str(), ic.m_Stamp);
+	}
+	catch (const std::exception& e)
+	{
+		BEAM_LOG_WARNING() << "Image checkpoint restore failed: " << e.what();
+	}
+
+	if (bOk)
+	{
+		BEAM_LOG_INFO() << "Image restored from checkpoint " << ic.m_Number.v;
+	}
+	else
+	{
+		BEAM_LOG_WARNING() << "Image checkpoint mismatch, rebuilding";
+
+		if (!m_Mapped.IsOpen())
+			m_Mapped.Open(m_sMappingPath.c_str(), ic.m_Stamp);
+
+		TxoID nTxos = m_Extra.m_Txos;
+		RebuildMapped();
+		m_Extra.m_Txos = nTxos;
 	}
+
+	m_Mapped.OnDirty(); // the stamp in the DB refers to the image before rollback
+}
+
+void NodeProcessor::SaveImageCheckpoint()
+{
+	if (!m_ImageCheckpoints.m_Period || !m_ImageCheckpoints.m_Count || m_ImageCheckpointsRefused || IsFastSync())
+		return;
+	if (!m_Mapped.IsOpen() || m_Mapped.get_Hdr().m_Dirty)
+		return; // should be consistent with the committed DB
+
+	Block::Number num = m_Cursor.m_Full.m_Number;
+	uint64_t iPeriod = num.v / m_ImageCheckpoints.m_Period;
+	if (!iPeriod)
+		return;
+
+	const Rules& r = Rules::get();
+	if (m_Cursor.m_Full.m_TimeStamp + static_cast<Timestamp>(r.DA.get_Target_s()) * r.MaxRollback < getTimestamp())
+		return; // far from the tip (sync in progress), it'd be beyond the rollback window anyway
+
+	std::vector<ImageCheckpoint> v;
+	LoadImageCheckpoints(v);
+
+	for (const auto& x : v)
+		if ((x.m_Number.v / m_ImageCheckpoints.m_Period == iPeriod) && IsImageCheckpointActive(x))
+			return; // already have it
+
+	uint32_t iSlot = static_cast<uint32_t>(iPeriod % m_ImageCheckpoints.m_Count);
+	if (v.size() <= iSlot)
+		v.resize(iSlot + 1);
+
+	ImageCheckpoint& ic = v[iSlot];
+	ic.m_Number = num;
+	ic.m_Hash = m_Cursor.m_hh.m_Hash;
+	ic.m_Stamp = m_Mapped.get_Hdr().m_Stamp;
+
+	std::string sPath;
+	get_ImageCheckpointPath(sPath, iSlot);
+
+	try
+	{
+		m_Mapped.Flush();
+		if (!MappedFileRaw::Clone(sPath.c_str(), m_sMappingPath.c_str(), m_ImageCheckpoints.m_AllowCopy))
+		{
+			BEAM_LOG_WARNING() << "Image checkpoints disabled: the filesystem doesn't support reflinks, and the full copy is not allowed";
+			m_ImageCheckpointsRefused = true;
+			return;
+		}
+	}
+	catch (const std::exception& e)
+	{
+		BEAM_LOG_WARNING() << "Image checkpoint failed: " << e.what();
+		return;
+	}
+
+	// if not committed - the stamp won't match the new file, and it'd just be ignored
+	Blob blob(&v.front(), static_cast<uint32_t>(sizeof(ImageCheckpoint) * v.size()));
+	m_DB.ParamSet(NodeDB::ParamID::ImageCheckpoints, nullptr, &blob);
+
+	BEAM_LOG_INFO() << "Image checkpoint " << num.v;
 }
 
 void NodeProcessor::RollbackDB()
@@ -838,14 +1567,7 @@ void NodeProcessor::EnumCongestions()
 			if (IsFastSync() && !x.IsContained(m_SyncData.m_Target))
 				continue; // ignore irrelevant branches
 
-			NodeDB::StateID sid;
-			sid.m_Number.v = x.m_Number.v - (x.m_Rows.size() - 1);
-			sid.m_Row = x.m_Rows.at(x.m_Rows.size() - 1);
-
-			m_DB.get_StateHash(sid.m_Row, id.m_Hash);
-			id.m_Number = sid.m_Number;
-
-			RequestDataInternal(id, sid.m_Row, true, sidTrg);
+			RequestBodies(x, sidTrg);
 		}
 		else
 		{
@@ -862,6 +1584,55 @@ void NodeProcessor::EnumCongestions()
 	}
 }
 
+void NodeProcessor::RequestBodies(CongestionCache::TipCongestion& x, const NodeDB::StateID& sidTrg)
+{
+	// rows are in descending order, the last one is the lowest missing block.
+	// The lowest chunk is always requested. The following ones start at their 1st missing block (those are downloaded from the bottom up),
+	// so that the progress is naturally resumed after restart
+	const uint32_t nSize = m_SyncChunks.m_Size;
+	size_t iPos = x.m_Rows.size() - 1;
+
+	for (uint32_t nChunks = 1; ; nChunks++)
+	{
+		NodeDB::StateID sid;
+		sid.m_Number.v = x.m_Number.v - iPos;
+		sid.m_Row = x.m_Rows.at(iPos);
+
+		if (IsFastSync() && (sid.m_Number.v > m_SyncData.m_Target.m_Number.v))
+			break; // not before the target is reached
+
+		bool bLast = !nSize || (nChunks >= m_SyncChunks.m_Count) || (iPos < nSize);
+
+		NodeDB::StateID sidEnd = sidTrg;
+		size_t iEnd = 0;
+		if (!bLast)
+		{
+			iEnd = iPos + 1 - nSize;
+			sidEnd.m_Number.v = x.m_Number.v - iEnd;
+			sidEnd.m_Row = x.m_Rows.at(iEnd);
+		}
+
+		Block::SystemState::ID id;
+		m_DB.get_StateHash(sid.m_Row, id.m_Hash);
+		id.m_Number = sid.m_Number;
+
+		RequestDataInternal(id, sid.m_Row, true, sidEnd);
+
+		if (bLast)
+			break;
+
+		for (iPos = iEnd; ; )
+		{
+			if (!iPos)
+				return; // all the rest is downloaded
+
+			iPos--;
+			if (!(NodeDB::StateFlags::Functional & m_DB.GetStateFlags(x.m_Rows.at(iPos))))
+				break;
+		}
+	}
+}
+
 const uint64_t* NodeProcessor::get_CachedRows(const NodeDB::StateID& sid, Height nCountExtra)
 {
 	EnumCongestionsInternal();
@@ -2232,23 +3003,6 @@ bool NodeProcessor::TxoIsNaked(const Blob& v)
 
 }
 
-struct NodeProcessor::KrnFlyMmr
-	:public Merkle::FlyMmr
-{
-	const TxVectors::Eternal& m_Txve;
-
-	KrnFlyMmr(const TxVectors::Eternal& txve)
-		:m_Txve(txve)
-	{
-		m_Count = txve.m_vKernels.size();
-	}
-
-	void LoadElement(Merkle::Hash& hv, uint64_t n) const override {
-		assert(n < m_Count);
-		hv = m_Txve.m_vKernels[n]->get_ID();
-	}
-};
-
 void NodeProcessor::EnsureCursorKernels()
 {
 	if (!m_Cursor.m_bKernels && m_Cursor.m_Row)
@@ -2703,18 +3457,23 @@ struct NodeProcessor::BlockInterpretCtx
 		:public bvm2::Storage::IBase
 	{
 		BlobMap::Set m_Vars;
+		BlobMap::Set m_Stored; // original values of the modified vars, written back once in Flush()
+		std::map<bvm2::ContractID, uint64_t> m_CodeStamps; // assigned on demand, reset when the code var is modified
 		BlobMap::Entry& get_Var(const Blob& key);
 
 		void LoadVar(const Blob&, Blob& res) override;
 		void LoadVarEx(Blob& key, Blob& res, bool bExact, bool bBigger) override;
 		uint32_t SaveVar(const Blob&, const Blob& val) override;
 		uint32_t OnLog(const Blob&, const Blob& val) override;
+		bool get_CodeStamp(const bvm2::ContractID&, uint64_t& nStamp) override;
 
 		BlobMap::Entry* FindVarEx(const Blob& key, bool bExact, bool bBigger);
 
 		void DataInsert(const Blob& key, const Blob&);
 		void DataUpdate(const Blob& key, const Blob& val, const Blob& valOld);
 		void DataDel(const Blob& key, const Blob& valOld);
+		void DataModify(const Blob& key, const Blob& valOld);
+		void Flush();
 
 		void DataToggleTree(const Blob& key, const Blob&, bool bAdd);
 		void DataSaveWithRecovery(BlobMap::Entry&, const Blob&);
@@ -2917,6 +3676,7 @@ bool NodeProcessor::HandleTreasury(const Blob& blob)
 		}
 	}
 
+	bic.m_Storage.Flush();
 	cf.Do(*this, 0);
 
 	if (bic.m_pvC)
@@ -4800,6 +5560,7 @@ bool NodeProcessor::BlockInterpretCtx::HandleValidatedBlock(const Block::Body& b
 		m_Proc.m_Extra.m_Txos++;
 	}
 
+	m_Storage.Flush(); // the definition is evaluated right after
 	return true;
 }
 
@@ -5410,10 +6171,7 @@ bool NodeProcessor::BlockInterpretCtx::BvmProcessor::Invoke(const bvm2::Contract
 		CallFar(cid, iMethod, m_Stack.get_AlasSp(), (uint32_t)krn.m_Args.size(), 0);
 
 		while (!IsDone())
-		{
-			DischargeUnits(bvm2::Limits::Cost::Cycle);
-			RunOnce();
-		}
+			RunCharged();
 
 		if (!m_Bic.m_AlreadyValidated)
 			CheckSigs(krn.m_Commitment, krn.m_Signature);
@@ -5887,6 +6645,8 @@ struct NodeProcessor::ProcessorInfoParser
 
 void NodeProcessor::BlockInterpretCtx::BvmProcessor::ParseExtraInfo(ContractInvokeExtraInfo& x, const bvm2::ShaderID& sid, uint32_t iMethod, const Blob& args)
 {
+	m_Bic.m_Storage.Flush(); // the parser reads vars from the DB
+
 	try
 	{
 		ProcessorInfoParser proc(m_Bic.m_Proc);
@@ -6080,26 +6840,79 @@ void NodeProcessor::BlockInterpretCtx::VmProcessorBase::UpdChargeWithRecovery(ui
 }
 
 
-void NodeProcessor::BlockInterpretCtx::Storage::DataInsert(const Blob& key, const Blob& data)
+void NodeProcessor::BlockInterpretCtx::Storage::DataInsert(const Blob& key, const Blob&)
 {
-	DataToggleTree(key, data, true);
-	if (!get_ParentObj().m_Temporary)
-		get_ParentObj().m_Proc.m_DB.ContractDataInsert(key, data);
+	DataModify(key, Blob(nullptr, 0));
 }
 
-void NodeProcessor::BlockInterpretCtx::Storage::DataUpdate(const Blob& key, const Blob& val, const Blob& valOld)
+void NodeProcessor::BlockInterpretCtx::Storage::DataUpdate(const Blob& key, const Blob&, const Blob& valOld)
 {
-	DataToggleTree(key, val, true);
-	DataToggleTree(key, valOld, false);
-	if (!get_ParentObj().m_Temporary)
-		get_ParentObj().m_Proc.m_DB.ContractDataUpdate(key, val);
+	DataModify(key, valOld);
 }
 
 void NodeProcessor::BlockInterpretCtx::Storage::DataDel(const Blob& key, const Blob& valOld)
 {
-	DataToggleTree(key, valOld, false);
-	if (!get_ParentObj().m_Temporary)
-		get_ParentObj().m_Proc.m_DB.ContractDataDel(key);
+	DataModify(key, valOld);
+}
+
+void NodeProcessor::BlockInterpretCtx::Storage::DataModify(const Blob& key, const Blob& valOld)
+{
+	if (bvm2::ContractID::nBytes == key.n)
+		m_CodeStamps.erase(*reinterpret_cast<const bvm2::ContractID*>(key.p)); // contract code
+
+	// the new value lives in m_Vars. Only remember the original one, the tree and the DB are updated in Flush()
+	if (!m_Stored.Find(key))
+		valOld.Export(m_Stored.Create(key)->m_Data);
+}
+
+bool NodeProcessor::BlockInterpretCtx::Storage::get_CodeStamp(const bvm2::ContractID& cid, uint64_t& nStamp)
+{
+	// all the modifications of the loaded vars go through DataModify(), which resets the stamp
+	auto it = m_CodeStamps.find(cid);
+	if (m_CodeStamps.end() == it)
+		it = m_CodeStamps.emplace(cid, bvm2::CodeCache::get_NewStamp()).first;
+
+	nStamp = it->second;
+	return true;
+}
+
+void NodeProcessor::BlockInterpretCtx::Storage::Flush()
+{
+	auto& bic = get_ParentObj(); // alias
+	auto& db = bic.m_Proc.m_DB;
+
+	while (!m_Stored.empty())
+	{
+		auto& eOld = *m_Stored.begin();
+		auto key = eOld.ToBlob();
+
+		const auto* pE = m_Vars.Find(key);
+		assert(pE);
+
+		Blob valOld(eOld.m_Data), val(pE->m_Data);
+		if (valOld != val) // the var may have been restored meanwhile
+		{
+			if (valOld.n)
+				DataToggleTree(key, valOld, false);
+			if (val.n)
+				DataToggleTree(key, val, true);
+
+			if (!bic.m_Temporary)
+			{
+				if (!valOld.n)
+					db.ContractDataInsert(key, val);
+				else
+				{
+					if (val.n)
+						db.ContractDataUpdate(key, val);
+					else
+						db.ContractDataDel(key);
+				}
+			}
+		}
+
+		m_Stored.Delete(eOld);
+	}
 }
 
 bool NodeProcessor::Mapped::Contract::IsStored(const Blob& key)
@@ -6145,8 +6958,9 @@ void NodeProcessor::Mapped::Contract::Toggle(const Blob& key, const Blob& data,
 
 void NodeProcessor::BlockInterpretCtx::Storage::DataToggleTree(const Blob& key, const Blob& data, bool bAdd)
 {
-	if (!get_ParentObj().m_SkipDefinition)
-		get_ParentObj().m_Proc.m_Mapped.m_Contract.Toggle(key, data, bAdd);
+	auto& bic = get_ParentObj(); // alias
+	if (!bic.m_SkipDefinition && bic.m_Proc.m_Mapped.IsOpen()) // the image may be detached during the rollback
+		bic.m_Proc.m_Mapped.m_Contract.Toggle(key, data, bAdd);
 }
 
 uint32_t NodeProcessor::BlockInterpretCtx::Storage::OnLog(const Blob& key, const Blob& val)
@@ -6571,6 +7385,38 @@ void NodeProcessor::RollbackTo(Block::Number num)
 
 	assert(num.v >= m_Extra.m_Fossil.v);
 
+	bool bChanged = false;
+
+	ImageCheckpoint ic;
+	uint32_t iSlot;
+	if (FindImageCheckpoint(ic, iSlot, num))
+	{
+		// undo the DB down to the checkpoint, the image is taken from it
+		m_Mapped.Close();
+		RollbackToInternal(ic.m_Number);
+		RestoreImageCheckpoint(ic, iSlot);
+
+		bChanged = true;
+	}
+
+	if (RollbackToInternal(num))
+		bChanged = true;
+
+	if (bChanged)
+	{
+		if (!TestDefinition())
+			OnCorrupted();
+
+		OnRolledBack();
+	}
+}
+
+bool NodeProcessor::RollbackToInternal(Block::Number num)
+{
+	// returns false if only the cursor was moved
+	if (num.v == m_Cursor.m_Full.m_Number.v)
+		return false;
+
 	IPbftHandler* pPbft = nullptr;
 	bool bFictive = false;
 
@@ -6604,13 +7450,19 @@ void NodeProcessor::RollbackTo(Block::Number num)
 			}
 		};
 
-		MyWalker wlk2;
-		wlk2.m_pThis = this;
+		// the image is detached if it's restored from a checkpoint afterwards
+		bool bImage = m_Mapped.IsOpen();
 
-		Block::NumberRange nr;
-		nr.m_Min = Block::Number(num.v + 1);
-		nr.m_Max = m_Cursor.m_Full.m_Number;
-		EnumTxos(wlk2, nr);
+		if (bImage)
+		{
+			MyWalker wlk2;
+			wlk2.m_pThis = this;
+
+			Block::NumberRange nr;
+			nr.m_Min = Block::Number(num.v + 1);
+			nr.m_Max = m_Cursor.m_Full.m_Number;
+			EnumTxos(wlk2, nr);
+		}
 
 		m_DB.TxoDelFrom(id0);
 
@@ -6636,11 +7488,14 @@ void NodeProcessor::RollbackTo(Block::Number num)
 				Input inp;
 				src.Get(inp.m_Commitment);
 
-				InputAux inpAux;
-				inpAux.m_ID = id;
-				inpAux.m_Maturity = GetInputMaturity(id);
+				if (bImage)
+				{
+					InputAux inpAux;
+					inpAux.m_ID = id;
+					inpAux.m_Maturity = GetInputMaturity(id);
 
-				UndoInput(inp, inpAux);
+					UndoInput(inp, inpAux);
+				}
 
 				m_DB.TxoSetSpent(id, MaxHeight);
 			}
@@ -6667,6 +7522,7 @@ void NodeProcessor::RollbackTo(Block::Number num)
 
 			bic.HandlePbftReward(txve.m_vKernels, pPbft);
 			bic.HandleElementVecBwd(txve.m_vKernels, txve.m_vKernels.size());
+			bic.m_Storage.Flush();
 
 			bic.m_Rollback.swap(bbR);
 			assert(bbR.empty());
@@ -6701,12 +7557,9 @@ void NodeProcessor::RollbackTo(Block::Number num)
 		m_DB.AssetEvtsDeleteFrom(h + 1);
 		m_DB.ShieldedOutpDelFrom(h + 1);
 		m_DB.KrnInfoDelFrom(h + 1);
-
-		if (!TestDefinition())
-			OnCorrupted();
-
-		OnRolledBack();
 	}
+
+	return !bFictive;
 }
 
 void NodeProcessor::AdjustManualRollbackNumber(Block::Number& num)
@@ -8446,6 +9299,7 @@ void NodeProcessor::RebuildNonStd()
 
 			Process(v);
 			bic.HandlePbftReward(v, m_pPbft);
+			bic.m_Storage.Flush();
 		
 			if (sid.m_Number.v > m_This.m_Extra.m_Fossil.v)
 			{
@@ -118,6 +118,7 @@ class NodeProcessor
 
 		void Close();
 		void FlushStrict(const Stamp&);
+		void Flush() { m_Mapping.Flush(); }
 
 #pragma pack(push, 1)
 		struct Hdr
@@ -148,6 +149,7 @@ class NodeProcessor
 	struct MultiAssetContext;
 
 	void RollbackTo(Block::Number);
+	bool RollbackToInternal(Block::Number);
 	uint64_t PruneOld();
 	uint64_t RaiseFossil(Block::Number);
 	uint64_t RaiseTxoLo(Block::Number);
@@ -199,6 +201,30 @@ class NodeProcessor
 	void InitCursor(bool bMovingUp, const NodeDB::StateID&);
 	bool InitMapping(const char*, bool bForceReset);
 	void InitializeMapped(const char*);
+	void RebuildMapped();
+
+	std::string m_sMappingPath;
+
+#pragma pack (push, 1)
+	struct ImageCheckpoint
+	{
+		Block::Number m_Number; // zero if the slot is free
+		Merkle::Hash m_Hash;
+		Mapped::Stamp m_Stamp;
+	};
+#pragma pack (pop)
+
+	void get_ImageCheckpointPath(std::string&, uint32_t iSlot) const;
+	void LoadImageCheckpoints(std::vector<ImageCheckpoint>&);
+	bool IsImageCheckpointActive(const ImageCheckpoint&);
+	bool FindImageCheckpoint(ImageCheckpoint&, uint32_t& iSlot, Block::Number);
+	void RestoreImageCheckpoint(const ImageCheckpoint&, uint32_t iSlot);
+	void SaveImageCheckpoint();
+	bool m_ImageCheckpointsRefused = false; // no reflink support, and the full copy isn't allowed
+
+	struct Snapshot;
+	bool ImportSnapshot(const char*);
+	bool TestSnapshot();
 
 	typedef std::pair<int64_t, std::pair<int64_t, Difficulty::Raw> > THW; // Time-Num-Work. Time and Num are signed
 	Difficulty get_NextDifficulty();
@@ -225,6 +251,7 @@ class NodeProcessor
 	} m_CongestionCache;
 
 	CongestionCache::TipCongestion* EnumCongestionsInternal();
+	void RequestBodies(CongestionCache::TipCongestion&, const NodeDB::StateID& sidTrg);
 
 	struct RecentStates
 	{
@@ -271,12 +298,18 @@ public:
 		};
 		uint8_t m_RichInfoFlags = 0;
 		Blob m_RichParser = Blob(nullptr, 0);
+
+		std::string m_sSnapshot; // if the node is empty - bootstrap it from this snapshot
 	};
 
 	void Initialize(const char* szPath);
 	void Initialize(const char* szPath, const StartParams&, ILongAction* pExternalHandler = nullptr);
 
 	static bool ExtractTreasury(const Blob&, Treasury::Data&);
+
+	// Online DB compaction: releases free pages (left after pruning) within the given time slice.
+	// Returns true if there's more to do.
+	bool CompactStep(uint32_t nTimeout_ms);
 	static void get_MappingPath(std::string&, const char*);
 
 	NodeProcessor();
@@ -285,6 +318,9 @@ public:
 	void ManualRollbackTo(Block::Number);
 	void ManualSelect(const Block::SystemState::ID&);
 
+	// current state image, enough to bootstrap another node. Verified against the tip Definition on import
+	bool ExportSnapshot(const char*, const Block::ChainWorkProof&);
+
 	struct Horizon {
 
 		// branches behind this are pruned
@@ -307,6 +343,21 @@ public:
 
 	} m_Horizon;
 
+	struct ImageCheckpoints {
+		// Periodic copies of the mapped image (reflinked where the filesystem supports it).
+		// Deep rollbacks undo the DB down to the nearest checkpoint without touching the image, and then take the image from it.
+		uint32_t m_Period = 0; // in blocks, 0 = disabled
+		uint32_t m_Count = 2;
+		uint32_t m_MinGap = 64; // not worth it for shallower rollbacks, the image copy is not free unless reflinked
+		bool m_AllowCopy = false; // if reflinks aren't supported - make a full copy (slow, blocks the commit). Otherwise the checkpoints are disabled
+	} m_ImageCheckpoints;
+
+	struct SyncChunks {
+		// The missing bodies range is split into chunks, requested independently (i.e. from different peers)
+		uint32_t m_Size = 500; // in blocks, 0 = disabled
+		uint32_t m_Count = 8; // max chunks requested at once
+	} m_SyncChunks;
+
 #pragma pack (push, 1)
 	struct StateExtra
 	{
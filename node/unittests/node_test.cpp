@@ -582,6 +582,30 @@ namespace beam
 		db.DeleteKernel(bBodyP, 5);
 		verify_test(db.FindKernel(bBodyP) == 0);
 
+		// enough to overfill the key filter, must be rebuilt transparently
+		const uint32_t nKrns = 0x1800;
+		for (uint32_t i = 0; i < nKrns; i++)
+		{
+			ECC::uintBig k = i * 2 + 1;
+			db.InsertKernel(k, 3);
+			verify_test(db.FindKernel(k) == 3);
+		}
+
+		for (uint32_t i = 0; i < nKrns; i++)
+		{
+			ECC::uintBig k = i * 2 + 1;
+			verify_test(db.FindKernel(k) == 3);
+			k = i * 2 + 2;
+			verify_test(!db.FindKernel(k));
+		}
+
+		for (uint32_t i = 0; i < nKrns; i++)
+		{
+			ECC::uintBig k = i * 2 + 1;
+			db.DeleteKernel(k, 3);
+			verify_test(!db.FindKernel(k));
+		}
+
 		// Shielded
 		TxoID nShielded = 16 * 1024 * 3 + 5;
 		db.ShieldedResize(nShielded, 0);
@@ -895,6 +919,106 @@ namespace beam
 		}
 	}
 
+	void TestBbsStore()
+	{
+		std::string sPath;
+		BbsStore::get_Path(sPath, g_sz);
+
+		BbsStore::Stamp stamp;
+		ECC::GenRandom(stamp);
+
+		BbsStore st;
+		st.m_SegmentSpan_s = 10;
+		st.Open(sPath.c_str(), stamp);
+		verify_test(!st.get_Totals().m_Count);
+
+		BbsStore::Data d;
+		for (uint32_t i = 0; i < 200; i++)
+		{
+			d.m_Key = i + 1;
+			d.m_Channel = i % 7;
+			d.m_TimePosted = i + 100;
+			d.m_Message.p = "hello";
+			d.m_Message.n = 5;
+			d.m_Nonce = i;
+
+			verify_test(st.Insert(d) == i + 1);
+		}
+
+		ByteBuffer buf;
+
+		for (uint32_t iPass = 0; iPass < 2; iPass++)
+		{
+			BbsStore::Key key = 5U;
+			const BbsStore::Msg* pMsg = st.Find(key);
+			verify_test(pMsg && (pMsg->m_ID == 5));
+
+			st.Read(*pMsg, d, buf);
+			verify_test((d.m_Channel == 4) && (d.m_Nonce == 4) && (d.m_TimePosted == 104));
+			verify_test((d.m_Message.n == 5) && !memcmp(d.m_Message.p, "hello", 5));
+
+			uint32_t nCount = 0;
+			for (uint64_t id = 0; st.get_NextInChannel(3, id); nCount++)
+				;
+			verify_test(nCount == 29);
+
+			verify_test(st.FindCursor(150) == 51);
+			verify_test(st.FindCursor(1000) == 201);
+			verify_test(st.get_MaxTime() == 299);
+			verify_test((st.get_Totals().m_Count == 200) && (st.get_Totals().m_Size == 1000));
+
+			// reload
+			st.Open(sPath.c_str(), stamp);
+		}
+
+		NodeDB::BbsTotals lims;
+		lims.m_Count = 1000;
+		lims.m_Size = 100000;
+
+		// expired segments are erased as a whole
+		verify_test(st.Cleanup(150, lims) == 50);
+		verify_test(!st.Find(BbsStore::Key(1U)));
+
+		uint64_t id = 0;
+		verify_test(st.get_Next(id) && (id == 51));
+
+		lims.m_Count = 100;
+		verify_test(st.Cleanup(0, lims) == 50);
+		verify_test(st.get_Totals().m_Count == 100);
+
+		d.m_Key = 1000U;
+		d.m_TimePosted = 299;
+		verify_test(st.Insert(d) == 201);
+
+		const BbsStore::Msg* pMsg = st.Find(d.m_Key);
+		verify_test(pMsg);
+		st.Read(*pMsg, d, buf);
+		verify_test(d.m_Message.n == 5);
+
+		st.Open(sPath.c_str(), stamp);
+		verify_test(st.get_Totals().m_Count == 101);
+
+		// IDs are preserved on reload
+		pMsg = st.Find(d.m_Key);
+		verify_test(pMsg && (pMsg->m_ID == 201));
+		id = 0;
+		verify_test(st.get_Next(id) && (id == 101));
+
+		// and continue after all the messages are erased
+		lims.m_Count = 0;
+		verify_test(st.Cleanup(0, lims) == 101);
+		st.Open(sPath.c_str(), stamp);
+		verify_test(!st.get_Totals().m_Count);
+
+		d.m_Key = 1001U;
+		verify_test(st.Insert(d) == 202);
+
+		// segments of another DB are discarded
+		stamp.Inc();
+		st.Open(sPath.c_str(), stamp);
+		verify_test(!st.get_Totals().m_Count);
+	}
+
 	struct MiniWallet
 	{
 		Key::IKdf::Ptr m_pKdf;
@@ -1126,6 +1250,9 @@ namespace beam
 	{
 		MyNodeProcessor1 np;
 		np.m_Horizon.m_Branching = 35;
+		np.m_ImageCheckpoints.m_Period = 4;
+		np.m_ImageCheckpoints.m_MinGap = 2;
+		np.m_ImageCheckpoints.m_AllowCopy = true; // the test may run on a filesystem without reflinks
 		np.Initialize(g_sz);
 		np.OnTreasury(g_Treasury);
 
@@ -1168,6 +1295,7 @@ namespace beam
 
 			np.OnBlock(id, bc.m_Body.m_Perishable, bc.m_Body.m_Eternal, PeerID());
 			np.TryGoUp();
+			np.CommitDB(); // may take the image checkpoint
 
 			np.m_Wallet.AddMyUtxo(CoinID(bc.m_Fees, h, Key::Type::Comission));
 			np.m_Wallet.AddMyUtxo(CoinID(Rules::get().get_Emission(h), h, Key::Type::Coinbase));
@@ -1203,6 +1331,31 @@ namespace beam
 
 		}
 
+		// rollback through the image checkpoint. The Definition is verified after the image is restored
+		Block::Number num = np.m_Cursor.m_Full.m_Number;
+		num.v -= Rules::get().MaxRollback - 1;
+		np.ManualRollbackTo(num);
+		verify_test(np.m_Cursor.m_Full.m_Number.v == num.v);
+
+		{
+			// without the copy fallback it's either a reflink, or refused with no leftovers
+			std::string sPath;
+			NodeProcessor::get_MappingPath(sPath, g_sz);
+			std::string sDst = sPath + ".clone";
+
+			if (MappedFileRaw::Clone(sDst.c_str(), sPath.c_str(), false))
+				verify_test(DeleteFile(sDst.c_str()));
+			else
+				verify_test(!DeleteFile(sDst.c_str()));
+		}
+
+		for (uint32_t i = 0; i < np.m_ImageCheckpoints.m_Count; i++)
+		{
+			std::string sPath;
+			NodeProcessor::get_MappingPath(sPath, g_sz);
+			sPath += ".ckpt" + std::to_string(i);
+			verify_test(DeleteFile(sPath.c_str()));
+		}
 	}
 
 
@@ -1300,6 +1453,9 @@ namespace beam
 			sp.m_CheckIntegrity = true;
 			sp.m_Vacuum = true;
 			np.Initialize(g_sz, sp);
+
+			verify_test(np.get_DB().IsVacuumIncremental());
+			verify_test(!np.CompactStep(100)); // just vacuumed, nothing to release
 		}
 
 	}
@@ -1978,6 +2134,10 @@ namespace beam
 		node2.m_Cfg.m_Dandelion = node.m_Cfg.m_Dandelion;
 		node2.m_Cfg.m_Horizon = node.m_Cfg.m_Horizon;
 		node2.m_Cfg.m_Horizon.m_Local = node2.m_Cfg.m_Horizon.m_Sync;
+		node2.m_Cfg.m_SyncChunks.m_Size = 4; // sync in small chunks
+
+		node.m_Cfg.m_CompactBlocks = true;
+		node2.m_Cfg.m_CompactBlocks = true; // new blocks are reconstructed from the pool, where possible
 
 		//node.m_PostStartSynced = true;
 		//node2.m_PostStartSynced = true;
@@ -3831,6 +3991,164 @@ namespace beam
 	}
 
 
+	void TestReconSketch()
+	{
+		typedef proto::Recon::Sketch Sketch;
+
+		uint64_t nSalt = 0x123456;
+		uint32_t nFails = 0, nRounds = 0;
+
+		for (uint32_t nDiff = 0; nDiff <= 200; nDiff += 5, nRounds++)
+		{
+			Sketch sk1, sk2;
+			sk1.Init(Sketch::get_CellsFor(nDiff));
+			sk2.Init(sk1.get_Cells());
+
+			std::set<uint64_t> s1, s2;
+
+			for (uint32_t i = 0; i < 500; i++)
+			{
+				// common
+				ECC::Hash::Value hv;
+				ECC::GenRandom(hv);
+				uint64_t id = proto::Recon::get_ShortID(hv, nSalt);
+				sk1.Add(id);
+				sk2.Add(id);
+			}
+
+			for (uint32_t i = 0; i < nDiff; i++)
+			{
+				ECC::Hash::Value hv;
+				ECC::GenRandom(hv);
+				uint64_t id = proto::Recon::get_ShortID(hv, nSalt);
+
+				if (1 & i)
+				{
+					sk1.Add(id);
+					s1.insert(id);
+				}
+				else
+				{
+					sk2.Add(id);
+					s2.insert(id);
+				}
+			}
+
+			ByteBuffer buf;
+			sk1.Write(buf);
+			verify_test(buf.size() == sk1.get_Cells() * Sketch::s_CellSize);
+
+			Sketch sk3;
+			verify_test(sk3.Read(buf));
+			sk3.Subtract(sk2);
+
+			std::vector<uint64_t> v1, v2;
+			if (!sk3.Decode(v1, v2))
+			{
+				nFails++; // probabilistic, should be rare
+				continue;
+			}
+
+			verify_test(std::set<uint64_t>(v1.begin(), v1.end()) == s1);
+			verify_test(std::set<uint64_t>(v2.begin(), v2.end()) == s2);
+		}
+
+		verify_test(nFails * 10 < nRounds);
+
+		// overflow must be detected
+		Sketch sk;
+		sk.Init(Sketch::s_CellsMin);
+		for (uint64_t i = 0; i < 100; i++)
+			sk.Add(i);
+
+		std::vector<uint64_t> v1, v2;
+		verify_test(!sk.Decode(v1, v2));
+
+		ByteBuffer buf(Sketch::s_CellSize * (Sketch::s_CellsMin + 1));
+		verify_test(!sk.Read(buf));
+	}
+
+	void TestTraficStats()
+	{
+		proto::TraficStats ts;
+
+		proto::TraficStats::Histogram& h = ts.m_pType[proto::NewTip::s_Code].m_Handle;
+		h.Add(0);
+		h.Add(9);
+		h.Add(10);
+		h.Add(999);
+		h.Add(1000);
+		h.Add(1000000);
+		h.Add(5000000000ULL);
+
+		verify_test(h.get_Count() == 7);
+		verify_test(h.m_pCount[0] == 2);
+		verify_test(h.m_pCount[1] == 1);
+		verify_test(h.m_pCount[2] == 1);
+		verify_test(h.m_pCount[3] == 1);
+		verify_test(h.m_pCount[6] == 2); // 1s and above
+		verify_test(h.m_Max_us == static_cast<uint32_t>(-1));
+
+		verify_test(!strcmp(proto::TraficStats::get_MsgName(proto::NewTip::s_Code), "NewTip"));
+		verify_test(!strcmp(proto::TraficStats::get_MsgName(proto::BodyPack::s_Code), "BodyPack"));
+
+		ts.Reset();
+		verify_test(!h.get_Count() && !h.m_Total_us);
+	}
+
+	void TestPipeline()
+	{
+		Node::Pipeline pl;
+
+		// not measured yet
+		pl.Update(1000000, 4);
+		verify_test(pl.m_Window == 1);
+
+		// bandwidth sample starts at the assignment if the peer was idle, or at the previous response otherwise
+		bool bIdle = false;
+		pl.m_Done_ms = 1000;
+		verify_test(pl.get_Start_ms(1200, bIdle) == 1200);
+		verify_test(bIdle);
+		verify_test(pl.get_Start_ms(1000, bIdle) == 1000);
+		verify_test(bIdle);
+
+		pl.m_Done_ms = 1500;
+		verify_test(pl.get_Start_ms(1200, bIdle) == 1500);
+		verify_test(!bIdle);
+
+		pl.m_Done_ms = 5; // wrapped
+		verify_test(pl.get_Start_ms(static_cast<uint32_t>(-16), bIdle) == 5);
+		verify_test(!bIdle);
+
+		// idle sample: 300ms, of which 100ms is the transfer
+		pl.OnResponse(100000, 300, true, 1000000, 1000000, 4);
+		verify_test(pl.m_Rtt_ms == 200);
+		verify_test(pl.m_SizeAvg == 100000);
+		verify_test(pl.m_Window == 3); // 1 + bdp / size
+
+		// pipelined sample doesn't affect the rtt
+		pl.OnResponse(100000, 50, false, 1000000, 1000000, 4);
+		verify_test(pl.m_Rtt_ms == 200);
+		verify_test(pl.m_Window == 3);
+
+		// transfer took longer than expected, no latency
+		pl.OnResponse(100000, 50, true, 1000000, 1000000, 4);
+		verify_test(pl.m_Rtt_ms == 150);
+
+		pl.Update(100000000, 4);
+		verify_test(pl.m_Window == 4); // capped
+
+		pl.Update(100000000, 0);
+		verify_test(pl.m_Window == 1);
+
+		// data missing or timeout
+		pl.Update(1000000, 4);
+		verify_test(pl.m_Window > 1);
+		pl.OnResponse(0, 100, true, 1000000, 1000000, 4);
+		verify_test(pl.m_Window == 1);
+		verify_test(pl.m_Rtt_ms == 150);
+	}
+
 	void TestChainworkProof()
 	{
 		printf("Preparing blockchain ...\n");
@@ -4093,6 +4411,44 @@ namespace beam
 		verify_test(fc.m_bTip);
 		verify_test(fc.m_hRolledTo <= hBranch.v); // must rollback beyond the manually appended state
 		verify_test(!fc.m_Hist.m_Map.empty() && fc.m_Hist.m_Map.rbegin()->second.m_Number.v == hThrd2.v);
+
+		// bootstrap another node from the state snapshot
+		verify_test(node.GenerateSnapshot(g_sz3));
+
+		{
+			DeleteFile(g_sz2);
+
+			NodeProcessor::StartParams sp;
+			sp.m_sSnapshot = g_sz3;
+
+			NodeProcessor np;
+			np.Initialize(g_sz2, sp);
+
+			const NodeProcessor& npSrc = node.get_Processor();
+			verify_test(np.m_Cursor.m_hh.m_Hash == npSrc.m_Cursor.m_hh.m_Hash);
+			verify_test(np.m_Extra.m_Txos == npSrc.m_Extra.m_Txos);
+			verify_test(np.m_Extra.m_TxoLo.v == np.m_Cursor.m_Full.m_Number.v);
+
+			// kernels are rebuilt from the imported bodies
+			uint32_t nKrns = 0;
+			NodeDB::WalkerKernel wlk;
+			for (np.get_DB().EnumKernels(wlk, 0); wlk.MoveNext(); nKrns++)
+				verify_test(Cast::NotConst(npSrc).get_DB().FindKernel(wlk.m_Key) == wlk.m_Height);
+			verify_test(nKrns);
+		}
+
+		{
+			// not empty anymore, the snapshot must be ignored
+			NodeProcessor::StartParams sp;
+			sp.m_sSnapshot = g_sz3;
+
+			NodeProcessor np;
+			np.Initialize(g_sz2, sp);
+			verify_test(np.m_Cursor.m_hh.m_Hash == node.get_Processor().m_Cursor.m_hh.m_Hash);
+		}
+
+		DeleteFile(g_sz2);
+		DeleteFile(g_sz3);
 	}
 
 	void TestHalving()
@@ -4467,8 +4823,501 @@ namespace beam
 			Height h = node.get_Processor().get_DB().FindKernel(hv);
 			verify_test(h == 21);
 		}
+
+		auto fnWaitTip = [&fc](Height h)
+		{
+			while (true)
+			{
+				Block::SystemState::Full s;
+				fc.m_Hist.get_Tip(s);
+				if (s.get_Height() >= h)
+					break;
+
+				Waiter wt;
+				fc.m_pW = &wt;
+				verify_test(wt.Wait());
+			}
+		};
+
+		fnWaitTip(21);
+
+		// 4. Vars enumeration cache. The node responds in small pages, each enumeration takes several requests
+		node.m_Cfg.m_BandwidthCtl.m_Chocking = 1;
+		const auto& statVars = node.get_TraficStats().m_pType[proto::ContractVarsEnum::s_Code].m_In;
+
+		man.m_Args["role"] = "manager";
+		man.m_Args["action"] = "view_accounts";
+
+		uint64_t nReqs = statVars.m_Msgs;
+		man.RunSync(1);
+		verify_test(!man.m_Err);
+		verify_test(statVars.m_Msgs >= nReqs + 2); // more than a single page
+
+		std::string sOut = man.m_Out.str();
+		verify_test(sOut.find(std::to_string(3 * Rules::Coin)) != std::string::npos);
+
+		nReqs = statVars.m_Msgs;
+		man.RunSync(1);
+		verify_test(!man.m_Err);
+		verify_test(statVars.m_Msgs == nReqs); // no request posted
+		verify_test(man.m_Out.str() == sOut); // all the pages replayed from the cache
+
+		// 5. Modify the var in a new block, the cached result must not be used
+		man.m_Args["role"] = "my_account";
+		man.m_Args["action"] = "deposit";
+		man.m_Args["amount"] = std::to_string(5 * Rules::Coin);
+		man.BuildAndSend(*pNet);
+
+		RaiseNumberTo(node, Block::Number(22));
+		verify_test(node.get_Processor().get_DB().FindKernel(man.m_vKrnIds.back()) == 22);
+		fnWaitTip(22);
+
+		man.m_Args["role"] = "manager";
+		man.m_Args["action"] = "view_accounts";
+
+		nReqs = statVars.m_Msgs;
+		man.RunSync(1);
+		verify_test(!man.m_Err);
+		verify_test(statVars.m_Msgs > nReqs);
+		verify_test(man.m_Out.str() != sOut);
+		verify_test(man.m_Out.str().find(std::to_string(8 * Rules::Coin)) != std::string::npos);
+	}
+
+	void TestDecoderPool()
+	{
+		// Both nodes and the clients decode their inbound traffic on dedicated threads.
+		// One of the clients disconnects while the rest of its traffic is still being decoded (on both sides)
+		io::Reactor::Ptr pReactor(io::Reactor::create());
+		io::Reactor::Scope scope(*pReactor);
+
+		Node node;
+		node.m_Cfg.m_sPathLocal = g_sz;
+		node.m_Cfg.m_Listen.port(g_Port);
+		node.m_Cfg.m_Listen.ip(INADDR_ANY);
+		node.m_Cfg.m_MiningThreads = 0;
+		node.m_Cfg.m_Treasury = g_Treasury;
+		node.m_Cfg.m_DecoderThreads = 2;
+		ECC::SetRandom(node);
+		node.Initialize();
+
+		RaiseNumberTo(node, Block::Number(20));
+
+		Node node2;
+		node2.m_Cfg.m_sPathLocal = g_sz2;
+		node2.m_Cfg.m_MiningThreads = 0;
+		node2.m_Cfg.m_DecoderThreads = 2;
+		ECC::SetRandom(node2);
+
+		io::Address addr;
+		addr.resolve("127.0.0.1");
+		addr.port(g_Port);
+		node2.m_Cfg.m_Connect.push_back(addr);
+		node2.Initialize();
+
+		proto::DecoderPool pool;
+		pool.Start(1);
+
+		struct MyClient
+			:public proto::NodeConnection
+		{
+			uint32_t m_Pings = 5000;
+			uint32_t m_Pongs = 0;
+			bool m_Abort = false;
+
+			void OnConnectedSecure() override
+			{
+				for (uint32_t i = 0; i < m_Pings; i++)
+					Send(proto::Ping());
+			}
+
+			void OnMsg(proto::Pong&&) override
+			{
+				m_Pongs++;
+				if (m_Abort)
+					Reset(); // the rest of the pongs are still being decoded
+			}
+
+			void OnDisconnect(const DisconnectReason&) override {
+				fail_test("OnDisconnect");
+			}
+		};
+
+		MyClient clAbort, cl;
+		clAbort.m_Abort = true;
+		clAbort.m_pDecoderPool = &pool;
+		cl.m_pDecoderPool = &pool;
+
+		clAbort.Connect(addr);
+		cl.Connect(addr);
+
+		struct MyWaiter
+		{
+			Node& m_Node;
+			Node& m_Node2;
+			const MyClient& m_Cl;
+			io::Timer::Ptr m_pTimer;
+			uint32_t m_Remaining = 200; // 20 sec
+
+			MyWaiter(Node& n, Node& n2, const MyClient& cl) :m_Node(n), m_Node2(n2), m_Cl(cl) {}
+
+			bool IsDone() const
+			{
+				return
+					(m_Cl.m_Pings == m_Cl.m_Pongs) &&
+					(m_Node2.get_Processor().m_Cursor.m_Full.m_Number.v == m_Node.get_Processor().m_Cursor.m_Full.m_Number.v);
+			}
+
+			void OnTimer()
+			{
+				if (IsDone() || !--m_Remaining)
+					io::Reactor::get_Current().stop();
+			}
+		};
+
+		MyWaiter wt(node, node2, cl);
+		wt.m_pTimer = io::Timer::create(*pReactor);
+		wt.m_pTimer->start(100, true, [&wt]() { wt.OnTimer(); });
+
+		pReactor->run();
+		wt.m_pTimer->cancel();
+
+		verify_test(wt.IsDone());
+		verify_test(clAbort.m_Pongs == 1); // nothing dispatched after the disconnect
+
+		cl.Reset();
+		pool.Stop();
+	}
+
+	void TestSyncStraggler()
+	{
+		// node3 syncs in chunks from node and node2, the latter never responds to the chunk requests.
+		// The stuck chunk should be requested from node as well, and node2 should not be dropped
+		io::Reactor::Ptr pReactor(io::Reactor::create());
+		io::Reactor::Scope scope(*pReactor);
+
+		io::Address addr, addr2;
+		addr.resolve("127.0.0.1");
+		addr.port(g_Port);
+		addr2.resolve("127.0.0.1");
+		addr2.port(g_Port + 1);
+
+		Node node;
+		node.m_Cfg.m_sPathLocal = g_sz;
+		node.m_Cfg.m_Listen.port(g_Port);
+		node.m_Cfg.m_Listen.ip(INADDR_ANY);
+		node.m_Cfg.m_MiningThreads = 0;
+		node.m_Cfg.m_Treasury = g_Treasury;
+		ECC::SetRandom(node);
+		node.Initialize();
+
+		RaiseNumberTo(node, Block::Number(40));
+
+		Node node2;
+		node2.m_Cfg.m_sPathLocal = g_sz2;
+		node2.m_Cfg.m_Listen.port(g_Port + 1);
+		node2.m_Cfg.m_Listen.ip(INADDR_ANY);
+		node2.m_Cfg.m_MiningThreads = 0;
+		node2.m_Cfg.m_Connect.push_back(addr);
+		ECC::SetRandom(node2);
+		node2.Initialize();
+
+		struct MyWaiter
+		{
+			Node& m_Node;
+			Node* m_pNode2 = nullptr;
+			io::Timer::Ptr m_pTimer;
+			uint32_t m_Remaining = 200; // 20 sec
+
+			MyWaiter(Node& n) :m_Node(n) {}
+
+			bool IsSynced() const
+			{
+				return m_pNode2->get_Processor().m_Cursor.m_Full.m_Number.v == m_Node.get_Processor().m_Cursor.m_Full.m_Number.v;
+			}
+
+			void OnTimer()
+			{
+				if (IsSynced() || !--m_Remaining)
+					io::Reactor::get_Current().stop();
+			}
+
+			bool Run(Node& n2)
+			{
+				m_pNode2 = &n2;
+				m_Remaining = 200;
+
+				m_pTimer = io::Timer::create(io::Reactor::get_Current());
+				m_pTimer->start(100, true, [this]() { OnTimer(); });
+
+				io::Reactor::get_Current().run();
+				m_pTimer->cancel();
+
+				return IsSynced();
+			}
+		};
+
+		MyWaiter wt(node);
+		verify_test(wt.Run(node2));
+
+		node2.m_Cfg.m_TestMode.m_StallBodyPacks = true;
+		uint64_t nBodyReqs = node2.get_TraficStats().m_pType[proto::GetBodyPack::s_Code].m_In.m_Msgs;
+
+		Node node3;
+		node3.m_Cfg.m_sPathLocal = g_sz3;
+		node3.m_Cfg.m_MiningThreads = 0;
+		node3.m_Cfg.m_Connect.push_back(addr);
+		node3.m_Cfg.m_Connect.push_back(addr2);
+		node3.m_Cfg.m_SyncChunks.m_Size = 4;
+		node3.m_Cfg.m_MaxConcurrentBlocksRequest = 1; // the rest are parallel chunks, one per peer
+		node3.m_Cfg.m_Timeout.m_SyncChunkStraggler_ms = 0;
+		ECC::SetRandom(node3);
+		node3.Initialize();
+
+		verify_test(wt.Run(node3));
+
+		// node2 got its chunk, but didn't respond. It's still connected, since the request didn't time out
+		verify_test(node2.get_TraficStats().m_pType[proto::GetBodyPack::s_Code].m_In.m_Msgs > nBodyReqs);
+
+		std::vector<Node::PeerTrafic> vPeers;
+		node3.get_PeersTrafic(vPeers);
+
+		bool bConnected2 = false;
+		for (const auto& x : vPeers)
+			if (x.m_Addr == addr2)
+				bConnected2 = true;
+		verify_test(bConnected2);
+	}
+
+	void TestReconRelay(uint32_t nPeriod2_ms)
+	{
+		// node2 connects to node, hence node is the responder. With a huge period on node2 the rounds are never initiated,
+		// and the pending txs and bbs messages reach node2 only via the responder timeout
+		io::Reactor::Ptr pReactor(io::Reactor::create());
+		io::Reactor::Scope scope(*pReactor);
+
+		MiniWallet wallet;
+		ECC::SetRandom(wallet.m_pKdf);
+
+		Node node;
+		node.m_Cfg.m_sPathLocal = g_sz;
+		node.m_Cfg.m_Listen.port(g_Port);
+		node.m_Cfg.m_Listen.ip(INADDR_ANY);
+		node.m_Cfg.m_MiningThreads = 0;
+		node.m_Cfg.m_Treasury = g_Treasury;
+		node.m_Cfg.m_Recon.m_Period_ms = 100;
+		node.m_Keys.SetSingleKey(wallet.m_pKdf);
+		node.m_Keys.m_pMiner = node.m_Keys.m_pGeneric;
+		node.Initialize();
+		node.m_PostStartSynced = true;
+
+		RaiseNumberTo(node, Block::Number(15));
+
+		Node node2;
+		node2.m_Cfg.m_sPathLocal = g_sz2;
+		node2.m_Cfg.m_MiningThreads = 0;
+		node2.m_Cfg.m_Recon.m_Period_ms = nPeriod2_ms;
+		ECC::SetRandom(node2);
+
+		io::Address addr;
+		addr.resolve("127.0.0.1");
+		addr.port(g_Port);
+		node2.m_Cfg.m_Connect.push_back(addr);
+		node2.Initialize();
+		node2.m_PostStartSynced = true;
+
+		struct MyClient
+			:public proto::NodeConnection
+		{
+			Transaction::Ptr m_pTx;
+			uint32_t m_Accepted = 0;
+
+			void OnConnectedSecure() override
+			{
+				SendLogin();
+
+				proto::NewTransaction msgTx;
+				msgTx.m_Transaction = std::move(m_pTx);
+				msgTx.m_Fluff = true;
+				Send(msgTx);
+
+				proto::BbsMsg msgBbs;
+				msgBbs.m_Channel = 5;
+				msgBbs.m_TimePosted = getTimestamp();
+				msgBbs.m_Message.resize(1, 0x5a);
+				msgBbs.m_Nonce = Zero;
+				Send(msgBbs);
+			}
+
+			void OnMsg(proto::Status&& msg) override
+			{
+				verify_test(proto::TxStatus::Ok == msg.m_Value);
+				m_Accepted++;
+			}
+
+			void OnDisconnect(const DisconnectReason&) override {
+				fail_test("OnDisconnect");
+			}
+		};
+
+		MyClient cl;
+
+		Height h0 = 1;
+		wallet.AddMyUtxo(CoinID(Rules::get().get_Emission(h0), h0, Key::Type::Coinbase));
+		verify_test(wallet.MakeTx(cl.m_pTx, node.get_Processor().m_Cursor.m_hh.m_Height, 0));
+
+		cl.Connect(addr);
+
+		struct MyWaiter
+		{
+			const Node& m_Node2;
+			io::Timer::Ptr m_pTimer;
+			uint32_t m_Remaining = 200; // 20 sec
+
+			MyWaiter(const Node& n) :m_Node2(n) {}
+
+			bool IsRelayed() const
+			{
+				const auto& s = m_Node2.get_TraficStats();
+				return
+					s.m_pType[proto::NewTransaction::s_Code].m_In.m_Msgs &&
+					s.m_pType[proto::BbsMsg::s_Code].m_In.m_Msgs;
+			}
+
+			void OnTimer()
+			{
+				if (IsRelayed() || !--m_Remaining)
+					io::Reactor::get_Current().stop();
+			}
+		};
+
+		MyWaiter wt(node2);
+		wt.m_pTimer = io::Timer::create(*pReactor);
+		wt.m_pTimer->start(100, true, [&wt]() { wt.OnTimer(); });
+
+		pReactor->run();
+		wt.m_pTimer->cancel();
+
+		verify_test(cl.m_Accepted == 1);
+		verify_test(wt.IsRelayed());
+
+		uint64_t nSketches = node2.get_TraficStats().m_pType[proto::ReconSketch::s_Code].m_Out.m_Msgs;
+		if (nPeriod2_ms > 10000)
+			verify_test(!nSketches); // delivered by the responder timeout
+		else
+			verify_test(nSketches);
 	}
 
+	void TestCompactBlocks(bool bMissing)
+	{
+		// node2 catches up with node, then node mines a block with a tx from its pool. node2 reconstructs it from its own pool,
+		// or requests the missing tx elements if it doesn't have them
+		io::Reactor::Ptr pReactor(io::Reactor::create());
+		io::Reactor::Scope scope(*pReactor);
+
+		MiniWallet wallet;
+		ECC::SetRandom(wallet.m_pKdf);
+
+		Node node;
+		node.m_Cfg.m_sPathLocal = g_sz;
+		node.m_Cfg.m_Listen.port(g_Port);
+		node.m_Cfg.m_Listen.ip(INADDR_ANY);
+		node.m_Cfg.m_MiningThreads = 0;
+		node.m_Cfg.m_Treasury = g_Treasury;
+		node.m_Cfg.m_CompactBlocks = true;
+		node.m_Keys.SetSingleKey(wallet.m_pKdf);
+		node.m_Keys.m_pMiner = node.m_Keys.m_pGeneric;
+		node.Initialize();
+		node.m_PostStartSynced = true;
+
+		RaiseNumberTo(node, Block::Number(15));
+
+		Node node2;
+		node2.m_Cfg.m_sPathLocal = g_sz2;
+		node2.m_Cfg.m_MiningThreads = 0;
+		node2.m_Cfg.m_CompactBlocks = true;
+		ECC::SetRandom(node2);
+
+		io::Address addr;
+		addr.resolve("127.0.0.1");
+		addr.port(g_Port);
+		node2.m_Cfg.m_Connect.push_back(addr);
+		node2.Initialize();
+		node2.m_PostStartSynced = true;
+
+		auto fnWait = [&pReactor](const std::function<bool()>& fnDone)
+		{
+			uint32_t nRemaining = 200; // 20 sec
+			io::Timer::Ptr pTimer = io::Timer::create(*pReactor);
+			pTimer->start(100, true, [&fnDone, &nRemaining]() {
+				if (fnDone() || !--nRemaining)
+					io::Reactor::get_Current().stop();
+			});
+
+			pReactor->run();
+			pTimer->cancel();
+			return fnDone();
+		};
+
+		auto fnNumber2 = [&node2]() { return node2.get_Processor().m_Cursor.m_Full.m_Number.v; };
+
+		verify_test(fnWait([&fnNumber2]() { return fnNumber2() >= 15; }));
+		verify_test(!node2.get_CompactStats().m_Built); // catch-up, nothing to announce
+		verify_test(!node2.get_CompactStats().m_Reconstructed);
+
+		struct MyClient
+			:public proto::NodeConnection
+		{
+			Transaction::Ptr m_pTx;
+
+			void OnConnectedSecure() override
+			{
+				SendLogin();
+
+				proto::NewTransaction msgTx;
+				msgTx.m_Transaction = std::move(m_pTx);
+				msgTx.m_Fluff = true;
+				Send(msgTx);
+			}
+
+			void OnMsg(proto::Status&& msg) override
+			{
+				verify_test(proto::TxStatus::Ok == msg.m_Value);
+			}
+
+			void OnDisconnect(const DisconnectReason&) override {
+				fail_test("OnDisconnect");
+			}
+		};
+
+		MyClient cl;
+
+		Height h0 = 1;
+		wallet.AddMyUtxo(CoinID(Rules::get().get_Emission(h0), h0, Key::Type::Coinbase));
+		verify_test(wallet.MakeTx(cl.m_pTx, node.get_Processor().m_Cursor.m_hh.m_Height, 0));
+
+		cl.Connect(addr);
+
+		verify_test(fnWait([&node2]() { return !node2.m_TxPool.m_setTxs.empty(); }));
+
+		if (bMissing)
+			node2.m_TxPool.Delete(node2.m_TxPool.m_setTxs.begin()->get_ParentObj());
+
+		const auto& s2 = node2.get_TraficStats();
+		uint64_t nBodyReqs = s2.m_pType[proto::GetBody::s_Code].m_Out.m_Msgs + s2.m_pType[proto::GetBodyPack::s_Code].m_Out.m_Msgs;
+
+		RaiseNumberTo(node, Block::Number(16)); // the tx is included
+		verify_test(node.m_TxPool.m_setProfit.empty());
+		verify_test(node.get_CompactStats().m_Built == 1);
+
+		verify_test(fnWait([&fnNumber2]() { return fnNumber2() >= 16; }));
+
+		verify_test(node2.get_CompactStats().m_Reconstructed == 1);
+		verify_test(s2.m_pType[proto::CompactBlock::s_Code].m_In.m_Msgs == 1);
+		verify_test(s2.m_pType[proto::GetCompactMissing::s_Code].m_Out.m_Msgs == (bMissing ? 1U : 0U));
+		verify_test(s2.m_pType[proto::GetBody::s_Code].m_Out.m_Msgs + s2.m_pType[proto::GetBodyPack::s_Code].m_Out.m_Msgs == nBodyReqs); // not downloaded
+	}
+
+
 
 
 }
@@ -4506,6 +5355,9 @@ void TestAll()
 	if (!bClientProtoOnly)
 	{
 		beam::TestHalving();
+		beam::TestReconSketch();
+		beam::TestTraficStats();
+		beam::TestPipeline();
 		beam::TestChainworkProof();
 	}
 
@@ -4525,6 +5377,11 @@ void TestAll()
 		beam::TestNodeDB();
 		beam::DeleteFile(beam::g_sz);
 
+		printf("BbsStore test...\n");
+		fflush(stdout);
+
+		beam::TestBbsStore();
+
 		{
 			printf("NodeProcessor test1...\n");
 			fflush(stdout);
@@ -4641,6 +5498,43 @@ void TestAll()
 	beam::TestDependentTxs();
 	beam::DeleteFile(beam::g_sz);
 	beam::DeleteFile(beam::g_sz2);
+
+	printf("Node <---> Node decoder pool test...\n");
+	fflush(stdout);
+
+	beam::TestDecoderPool();
+	beam::DeleteFile(beam::g_sz);
+	beam::DeleteFile(beam::g_sz2);
+
+	printf("Node <---> Node sync straggler test...\n");
+	fflush(stdout);
+
+	beam::TestSyncStraggler();
+	beam::DeleteFile(beam::g_sz);
+	beam::DeleteFile(beam::g_sz2);
+	beam::DeleteFile(beam::g_sz3);
+
+	printf("Node <---> Node recon relay test...\n");
+	fflush(stdout);
+
+	beam::TestReconRelay(100);
+	beam::DeleteFile(beam::g_sz);
+	beam::DeleteFile(beam::g_sz2);
+
+	beam::TestReconRelay(3600 * 1000); // rounds are never initiated, relies on the responder timeout
+	beam::DeleteFile(beam::g_sz);
+	beam::DeleteFile(beam::g_sz2);
+
+	printf("Node <---> Node compact blocks test...\n");
+	fflush(stdout);
+
+	beam::TestCompactBlocks(false);
+	beam::DeleteFile(beam::g_sz);
+	beam::DeleteFile(beam::g_sz2);
+
+	beam::TestCompactBlocks(true); // the tx is missing in the receiver pool, requested
+	beam::DeleteFile(beam::g_sz);
+	beam::DeleteFile(beam::g_sz2);
 }
 
 thread_local const beam::Rules* beam::Rules::s_pInstance = nullptr;
@@ -49,6 +49,9 @@ public:
     /// Disables all messages
     void disable_all_msg_types() { _msgReader.disable_all_msg_types(); }
 
+    /// Delivers the incoming data as-is to the given callback, bypassing the msg reader
+    void redirect_read(const io::TcpStream::Callback& callback) { _stream->enable_read(callback); }
+
 private:
     MsgReader _msgReader;
 };
@@ -18,6 +18,73 @@
 
 namespace beam {
 
+MsgBufferPool& MsgBufferPool::get() {
+    static MsgBufferPool s_Pool;
+    return s_Pool;
+}
+
+void MsgBufferPool::acquire(Block& b, size_t size) {
+    assert(!b.data);
+    {
+        std::unique_lock<std::mutex> scope(_mutex);
+
+        size_t iBest = _blocks.size();
+        for (size_t i = 0; i < _blocks.size(); i++) {
+            size_t n = _blocks[i].size;
+            if ((n >= size) && ((iBest == _blocks.size()) || (n < _blocks[iBest].size)))
+                iBest = i;
+        }
+
+        if (iBest < _blocks.size()) {
+            b = std::move(_blocks[iBest]);
+            _blocks[iBest] = std::move(_blocks.back());
+            _blocks.pop_back();
+            _total -= b.size;
+            return;
+        }
+    }
+
+    b.size = (size + s_Granularity - 1) / s_Granularity * s_Granularity;
+    b.data.reset(new uint8_t[b.size]); // not initialized
+}
+
+void MsgBufferPool::release(Block& b) {
+    if (!b.data)
+        return;
+
+    Block bFree; // freed outside the lock
+    {
+        std::unique_lock<std::mutex> scope(_mutex);
+
+        if (b.size <= s_TotalMax) {
+            // evict smaller blocks if necessary
+            while ((_blocks.size() >= s_BlocksMax) || (_total + b.size > s_TotalMax)) {
+                size_t iMin = 0;
+                for (size_t i = 1; i < _blocks.size(); i++)
+                    if (_blocks[i].size < _blocks[iMin].size)
+                        iMin = i;
+
+                if (_blocks[iMin].size >= b.size)
+                    break;
+
+                _total -= _blocks[iMin].size;
+                _blocks[iMin] = std::move(_blocks.back());
+                _blocks.pop_back();
+            }
+
+            if ((_blocks.size() < s_BlocksMax) && (_total + b.size <= s_TotalMax)) {
+                _total += b.size;
+                _blocks.push_back(std::move(b));
+            }
+        }
+
+        if (b.data)
+            bFree = std::move(b);
+    }
+
+    b.size = 0;
+}
+
 MsgReader::MsgReader(ProtocolBase& protocol, uint64_t streamId, size_t defaultSize) :
     _protocol(protocol),
     _streamId(streamId),
@@ -29,8 +96,10 @@ MsgReader::MsgReader(ProtocolBase& protocol, uint64_t streamId, size_t defaultSi
 	*_pAlive = true;
 
     assert(_defaultSize >= MsgHeader::SIZE);
-    _msgBuffer.resize(_defaultSize);
-    _cursor = _msgBuffer.data();
+    _ownSize = _defaultSize;
+    _ownBuffer.reset(new uint8_t[_ownSize]);
+    _msgBuffer = _ownBuffer.get();
+    _cursor = _msgBuffer;
 
     // by default, all message types are allowed
     enable_all_msg_types();
@@ -40,12 +109,44 @@ MsgReader::~MsgReader()
 {
 	if (_pAlive)
 		*_pAlive = false;
+
+    release_buffer();
 }
 
 void MsgReader::reset() {
+    release_buffer();
     _bytesLeft = MsgHeader::SIZE;
     _state = reading_header;
-    _cursor = _msgBuffer.data();
+    _cursor = _msgBuffer;
+}
+
+void MsgReader::prepare_buffer(size_t size) {
+    // the header is already in the current buffer, and must be preserved
+    if (size <= _ownSize) {
+        assert(_msgBuffer == _ownBuffer.get());
+        return;
+    }
+
+    if (size <= s_OwnMax) {
+        size_t n = std::min(std::max(size, _ownSize * 2), s_OwnMax);
+        std::unique_ptr<uint8_t[]> pBuf(new uint8_t[n]);
+        memcpy(pBuf.get(), _msgBuffer, MsgHeader::SIZE);
+
+        _ownBuffer.swap(pBuf);
+        _ownSize = n;
+        _msgBuffer = _ownBuffer.get();
+    } else {
+        MsgBufferPool::get().acquire(_poolBuffer, size);
+        memcpy(_poolBuffer.data.get(), _msgBuffer, MsgHeader::SIZE);
+        _msgBuffer = _poolBuffer.data.get();
+    }
+}
+
+void MsgReader::release_buffer() {
+    if (_poolBuffer.data) {
+        MsgBufferPool::get().release(_poolBuffer);
+        _msgBuffer = _ownBuffer.get();
+    }
 }
 
 void MsgReader::change_id(uint64_t newStreamId) {
@@ -69,54 +170,120 @@ void MsgReader::disable_all_msg_types() {
 }
 
 bool MsgReader::new_data_from_stream(io::ErrorCode connectionStatus, const void* data, size_t size) {
+    // const data, can't be processed in-place
+    return on_data(connectionStatus, (uint8_t*) data, size, false);
+}
+
+bool MsgReader::new_data_from_stream(io::ErrorCode connectionStatus, void* data, size_t size) {
+    return on_data(connectionStatus, (uint8_t*) data, size, true);
+}
+
+bool MsgReader::on_header(const MsgHeader& header, volatile const bool& bAlive) {
+	if (!_protocol.approve_msg_header(_streamId, header))
+		// at this moment, the *this* may be deleted
+		return false;
+
+	if (!bAlive)
+		return false;
+
+	if (!_expectedMsgTypes.test(header.type)) {
+		_protocol.on_unexpected_msg(_streamId, header.type);
+		// at this moment, the *this* may be deleted
+		return false;
+	}
+
+	return bAlive;
+}
+
+bool MsgReader::on_message(const uint8_t* pMsg, const MsgHeader& header, volatile const bool& bAlive) {
+	if (!_protocol.VerifyMsg(pMsg, static_cast<uint32_t>(MsgHeader::SIZE + header.size)))
+	{
+		_protocol.on_corrupt_msg(_streamId);
+		return false;
+	}
+
+    if (!_protocol.on_new_message(_streamId, header.type, pMsg + MsgHeader::SIZE, header.size - _protocol.get_MacSize())) {
+        // at this moment, the *this* may be deleted
+        if (bAlive) {
+            reset();
+        }
+        return false;
+    }
+
+	return bAlive;
+}
+
+bool MsgReader::on_data(io::ErrorCode connectionStatus, uint8_t* p, size_t sz, bool bInPlace) {
     if (connectionStatus != 0) {
         _protocol.on_connection_error(_streamId, connectionStatus);
         return false;
     }
 
-    if (!data || !size) {
+    if (!p || !sz) {
         return true;
     }
 
 	std::shared_ptr<bool> pAlive(_pAlive);
 	volatile const bool& bAlive = *pAlive;
 
-    const uint8_t* p = (const uint8_t*)data;
-    size_t sz = size;
-
-	while (sz >= _bytesLeft)
+	while (true)
 	{
+		if (bInPlace && (_state == reading_header) && (_bytesLeft == MsgHeader::SIZE) && (sz >= MsgHeader::SIZE))
+		{
+			// the header is entirely within the chunk
+			_protocol.Decrypt(p, MsgHeader::SIZE);
+			MsgHeader header(p);
+
+			if (!on_header(header, bAlive))
+				return false;
+
+			size_t nMsg = MsgHeader::SIZE + header.size;
+			if (sz >= nMsg)
+			{
+				// so is the message
+				_protocol.Decrypt(p + MsgHeader::SIZE, header.size);
+
+				if (!on_message(p, header, bAlive))
+					return false;
+
+				sz -= nMsg;
+				p += nMsg;
+				continue;
+			}
+
+			// continue in the buffer
+			prepare_buffer(nMsg);
+			memcpy(_msgBuffer, p, MsgHeader::SIZE);
+
+			sz -= MsgHeader::SIZE;
+			p += MsgHeader::SIZE;
+
+			_bytesLeft = header.size;
+			_cursor = _msgBuffer + MsgHeader::SIZE;
+			_state = reading_message;
+		}
+
+		if (sz < _bytesLeft)
+			break;
+
 		memcpy(_cursor, p, _bytesLeft);
 		_protocol.Decrypt(_cursor, (uint32_t) _bytesLeft); // decrypt as much as we expect, no more (because cipher may change)
 
 		sz -= _bytesLeft;
 		p += _bytesLeft;
 
-		MsgHeader header(_msgBuffer.data());
+		MsgHeader header(_msgBuffer);
 
 		if (_state == reading_header)
 		{
 			// header has just been read
-			if (!_protocol.approve_msg_header(_streamId, header))
-				// at this moment, the *this* may be deleted
-				return false;
-
-			if (!bAlive)
-				return false;
-
-			if (!_expectedMsgTypes.test(header.type)) {
-				_protocol.on_unexpected_msg(_streamId, header.type);
-				// at this moment, the *this* may be deleted
-				return false;
-			}
-
-			if (!bAlive)
+			if (!on_header(header, bAlive))
 				return false;
 
 			// header deserialized successfully
 			_bytesLeft = header.size;
-			_msgBuffer.resize(MsgHeader::SIZE + _bytesLeft);
-			_cursor = _msgBuffer.data() + MsgHeader::SIZE;
+			prepare_buffer(MsgHeader::SIZE + _bytesLeft);
+			_cursor = _msgBuffer + MsgHeader::SIZE;
 
 			_state = reading_message;
 
@@ -124,35 +291,11 @@ bool MsgReader::new_data_from_stream(io::ErrorCode connectionStatus, const void*
 		else
 		{
 			// whole message has been read
-			if (!_protocol.VerifyMsg(_msgBuffer.data(), static_cast<uint32_t>(_msgBuffer.size())))
-			{
-				_protocol.on_corrupt_msg(_streamId);
+			if (!on_message(_msgBuffer, header, bAlive))
 				return false;
-			}
-
-            if (!_protocol.on_new_message(_streamId, header.type, _msgBuffer.data() + MsgHeader::SIZE, header.size - _protocol.get_MacSize())) {
-                // at this moment, the *this* may be deleted
-                if (bAlive) {
-                    reset();
-                }
-                return false;
-            }
-
-			if (!bAlive)
-				return false;
-
-			if (_msgBuffer.size() > 2 * _defaultSize) {
-				{
-					std::vector<uint8_t> newBuffer;
-					_msgBuffer.swap(newBuffer);
-				}
-				// preventing from excessive memory consumption per individual stream
-				_msgBuffer.resize(_defaultSize);
-			}
-			_bytesLeft = MsgHeader::SIZE;
-			_state = reading_header;
 
-			_cursor = _msgBuffer.data();
+			// large buffer goes back to the pool, the own one is kept (its size is limited)
+			reset();
 		}
 	}
 
@@ -16,9 +16,38 @@
 #include "protocol_base.h"
 #include <vector>
 #include <bitset>
+#include <memory>
+#include <mutex>
 
 namespace beam {
 
+/// Shared (thread-safe) pool of buffers for large messages.
+/// Keeps a few recently used buffers, to avoid allocating (and touching) fresh memory for every large message
+class MsgBufferPool {
+public:
+    struct Block {
+        std::unique_ptr<uint8_t[]> data;
+        size_t size = 0;
+    };
+
+    static MsgBufferPool& get();
+
+    /// Returns the smallest cached block that fits, or allocates a new one
+    void acquire(Block& b, size_t size);
+
+    /// Returns the block to the pool, or frees it if the pool is full
+    void release(Block& b);
+
+private:
+    static constexpr size_t s_Granularity = 0x10000;
+    static constexpr size_t s_BlocksMax = 4;
+    static constexpr size_t s_TotalMax = 0x4000000;
+
+    std::mutex _mutex;
+    std::vector<Block> _blocks;
+    size_t _total = 0;
+};
+
 /// Extracts (serialized, raw data) individual messages from stream, performs header/size validation
 class MsgReader {
 public:
@@ -33,6 +62,10 @@ public:
     /// Calls the callback whenever a new protocol message is exctracted or on errors
     bool new_data_from_stream(io::ErrorCode connectionStatus, const void* data, size_t size);
 
+    /// Same, but the data is writable and may be modified (decrypted in-place).
+    /// Messages that are entirely within the chunk are dispatched directly from it, without copying
+    bool new_data_from_stream(io::ErrorCode connectionStatus, void* data, size_t size);
+
     /// Allows receiving messages of given type
     void enable_msg_type(MsgType type);
 
@@ -67,8 +100,16 @@ private:
     /// Current state
     State _state;
 
-    /// Message buffer, grows if needed
-    std::vector<uint8_t> _msgBuffer;
+    /// Own buffer, grows up to s_OwnMax if needed, kept between messages
+    std::unique_ptr<uint8_t[]> _ownBuffer;
+    size_t _ownSize;
+    static constexpr size_t s_OwnMax = 0x10000;
+
+    /// Borrowed from the pool for larger messages
+    MsgBufferPool::Block _poolBuffer;
+
+    /// Current message buffer, either of the above
+    uint8_t* _msgBuffer;
 
     /// Cursor inside the buffer
     uint8_t* _cursor;
@@ -77,6 +118,12 @@ private:
     std::bitset<256> _expectedMsgTypes;
 
 	std::shared_ptr<bool> _pAlive;
+
+    bool on_data(io::ErrorCode connectionStatus, uint8_t* p, size_t sz, bool bInPlace);
+    bool on_header(const MsgHeader&, volatile const bool& bAlive);
+    bool on_message(const uint8_t* pMsg, const MsgHeader&, volatile const bool& bAlive);
+    void prepare_buffer(size_t size);
+    void release_buffer();
 };
 
 } //namespace
@@ -107,6 +107,13 @@ public:
 		return _ser;
 	}
 
+	/// Same as above, for the message body serialized beforehand (i.e. once for many recipients)
+	MsgSerializer& serializeRawNoFinalize(SerializedMsg& out, MsgType type, const void* body, size_t size) {
+		_ser.new_message(type);
+		if (size) _ser.write_raw(body, size);
+		return _ser;
+	}
+
 	/// If externalTailSize > 0 then serialized msg must be followed by raw buffer of thet size
     template <typename MsgObject> io::SharedBuffer serialize(
         MsgType type, const MsgObject& obj, bool makeUnique, size_t externalTailSize=0
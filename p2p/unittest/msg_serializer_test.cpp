@@ -16,6 +16,7 @@
 #include "p2p/msg_reader.h"
 #include "p2p/protocol.h"
 #include "utility/helpers.h"
+#include "utility/common.h"
 #include <iostream>
 #include <assert.h>
 
@@ -53,6 +54,37 @@ void fragment_writer_test() {
     }
 }
 
+void fragment_pool_test() {
+    io::FragmentPool::trim();
+
+    for (int iCycle = 0; iCycle < 2; iCycle++) {
+        io::FragmentPool::Stats s0 = io::FragmentPool::get_stats();
+
+        std::vector<io::SharedBuffer> v;
+        for (size_t n : { 0, 1, 64, 65, 100, 20000, 20000, 60000, 100000 }) {
+            std::vector<uint8_t> data(n);
+            for (size_t i = 0; i < n; i++) data[i] = (uint8_t) (i * 13 + n);
+
+            v.emplace_back(data.data(), n);
+            assert(v.back().size == n);
+            assert(!n || !memcmp(v.back().data, data.data(), n));
+        }
+
+        v.clear();
+
+        io::FragmentPool::Stats s1 = io::FragmentPool::get_stats();
+        assert(s1.allocs - s0.allocs == 8); // empty buffer doesn't allocate
+        assert(s1.frees - s0.frees == 8);
+
+        if (iCycle) {
+            // all the cacheable sizes must be reused now
+            assert(s1.hits - s0.hits == 7);
+        }
+
+        (void) s0; (void) s1; // only checked by asserts
+    }
+}
+
 using IntList = std::vector<int>;
 
 struct SomeObject {
@@ -77,6 +109,7 @@ struct MsgHandler : IErrorHandler {
     bool on_ints(uint64_t fromStream, IntList&& msg, uint32_t) {
         cout << __FUNCTION__ << "(" << fromStream << "," << msg.size() << ")" << endl;
         receivedInts = msg;
+        numInts++;
         return true;
     }
 
@@ -88,6 +121,7 @@ struct MsgHandler : IErrorHandler {
 
     IntList receivedInts;
     SomeObject receivedObj;
+    size_t numInts = 0;
 };
 
 void msg_serializer_test_1() {
@@ -183,8 +217,95 @@ void msg_serializer_test_2() {
     assert(msg == handler.receivedObj);
 }
 
+void msg_serializer_raw_test() {
+    MsgType type = 111;
+
+    MsgHandler handler;
+    Protocol protocol(0xAA, 0xBB, 0xCC, 256, handler, 50);
+    protocol.add_message_handler<MsgHandler, SomeObject, &MsgHandler::on_some_object>(type, &handler, 8, 1<<24);
+
+    SomeObject msg;
+    msg.i = 5;
+    msg.x = 0x12345678;
+    for (int i=0; i<77; ++i) msg.ooo.push_back(i * 3);
+
+    std::vector<io::SharedBuffer> fragments;
+    protocol.serialize(fragments, type, msg);
+    io::SharedBuffer buf1 = io::normalize(fragments, true);
+
+    // the body serialized once, the message is framed per recipient
+    Serializer ser;
+    ser & msg;
+
+    for (int i = 0; i < 3; i++) {
+        fragments.clear();
+        MsgSerializer& ser2 = protocol.serializeRawNoFinalize(fragments, type, ser.buffer().first, ser.buffer().second);
+        ser2.finalize(fragments);
+        io::SharedBuffer buf2 = io::normalize(fragments, true);
+
+        assert(buf1.size == buf2.size);
+        assert(!memcmp(buf1.data, buf2.data, buf1.size));
+
+        handler.receivedObj = SomeObject();
+        MsgReader reader(protocol, 1, 100);
+        reader.new_data_from_stream(io::EC_OK, buf2.data, buf2.size);
+        assert(msg == handler.receivedObj);
+    }
+}
+
+void msg_reader_test() {
+    MsgType type = 77;
+
+    MsgHandler handler;
+    Protocol protocol(0xAA, 0xBB, 0xCC, 256, handler, 50);
+    protocol.add_message_handler<MsgHandler, IntList, &MsgHandler::on_ints>(type, &handler, 0, 1<<24);
+
+    // stream of messages of different sizes, the last one exceeds the reader own buffer
+    std::vector<IntList> msgs;
+    std::vector<uint8_t> stream;
+    for (int n : { 0, 1, 20, 5, 3000, 2, 40000 }) {
+        IntList& v = msgs.emplace_back();
+        for (int i = 0; i < n; i++) v.push_back(i * 7 + n);
+
+        std::vector<io::SharedBuffer> fragments;
+        protocol.serialize(fragments, type, v);
+        for (const auto& f : fragments)
+            stream.insert(stream.end(), f.data, f.data + f.size);
+    }
+
+    for (size_t nChunk : { stream.size(), size_t(1), size_t(7), size_t(100), size_t(4099) }) {
+        MsgReader reader(protocol, 1, 100);
+        handler.numInts = 0;
+
+        // writable chunks, processed in-place when possible
+        std::vector<uint8_t> buf(stream);
+        for (size_t i = 0; i < buf.size(); i += nChunk) {
+            size_t n = std::min(nChunk, buf.size() - i);
+            void* p = &buf[i];
+            BEAM_VERIFY(reader.new_data_from_stream(io::EC_OK, p, n));
+        }
+
+        assert(handler.numInts == msgs.size());
+        assert(handler.receivedInts == msgs.back());
+
+        // same, read-only
+        handler.numInts = 0;
+        for (size_t i = 0; i < stream.size(); i += nChunk) {
+            size_t n = std::min(nChunk, stream.size() - i);
+            const void* p = &stream[i];
+            BEAM_VERIFY(reader.new_data_from_stream(io::EC_OK, p, n));
+        }
+
+        assert(handler.numInts == msgs.size());
+        assert(handler.receivedInts == msgs.back());
+    }
+}
+
 int main() {
     fragment_writer_test();
+    fragment_pool_test();
     msg_serializer_test_1();
     msg_serializer_test_2();
+    msg_serializer_raw_test();
+    msg_reader_test();
 }
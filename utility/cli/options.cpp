@@ -84,6 +84,8 @@ namespace beam
         const char* MINING_THREADS = "mining_threads";
         const char* POW_SOLVE_TIME = "pow_solve_time";
         const char* VERIFICATION_THREADS = "verification_threads";
+        const char* DECODER_THREADS = "decoder_threads";
+        const char* COMPACT_BLOCKS = "compact_blocks";
         const char* NONCEPREFIX_DIGITS = "nonceprefix_digits";
         const char* NODE_PEER = "peer";
         const char* NODE_PEERS_PERSISTENT = "peers_persistent";
@@ -121,6 +123,8 @@ namespace beam
         const char* CONTRACT_RICH_PARSER = "contract_rich_parser";
         const char* CHECKDB = "check_db";
         const char* VACUUM = "vacuum";
+        const char* IMAGE_CHECKPOINT_PERIOD = "image_checkpoint_period";
+        const char* IMAGE_CHECKPOINT_COPY = "image_checkpoint_copy";
         const char* CRASH = "crash";
         const char* INIT = "init";
         const char* RESTORE = "restore";
@@ -174,6 +178,7 @@ namespace beam
         const char* LOG_VERBOSE = "verbose";
         const char* LOG_CLEANUP_DAYS = "log_cleanup_days";
         const char* LOG_UTXOS = "log_utxos";
+        const char* LOG_TRAFIC_STATS = "log_trafic_stats";
         const char* VERSION = "version";
         const char* VERSION_FULL = "version,v";
         const char* GIT_COMMIT_HASH = "git_commit_hash";
@@ -189,6 +194,8 @@ namespace beam
         const char* IP_WHITELIST = "ip_whitelist";
         const char* FAST_SYNC = "fast_sync";
         const char* GENERATE_RECOVERY_PATH = "generate_recovery";
+        const char* SNAPSHOT_EXPORT_PATH = "snapshot_export";
+        const char* SNAPSHOT_IMPORT_PATH = "snapshot_import";
         const char* RECOVERY_AUTO_PATH = "recovery_auto_path";
         const char* RECOVERY_AUTO_PERIOD = "recovery_auto_period";
         const char* SWAP_INIT = "swap_init";
@@ -262,6 +269,7 @@ namespace beam
         const char* API_ENABLE_IPFS = "enable_ipfs";
         const char* API_IPFS_STORAGE = "ipfs_storage";
         const char* API_TCP_MAX_LINE = "tcp_max_line";
+        const char* API_SHADER_WORKERS = "shader_workers";
 
         // treasury
         const char* TR_OPCODE = "tr_op";
@@ -403,6 +411,8 @@ namespace beam
             (cli::POW_SOLVE_TIME, po::value<uint32_t>()->default_value(15 * 1000), "pow solve time. It works if FakePoW is enabled")
 
             (cli::VERIFICATION_THREADS, po::value<int>()->default_value(-1), "number of threads for cryptographic verifications (0 = single thread, -1 = auto)")
+            (cli::DECODER_THREADS, po::value<uint32_t>()->default_value(0), "number of threads for decoding the incoming peers traffic (0 = decode on the main thread)")
+            (cli::COMPACT_BLOCKS, po::value<bool>()->default_value(false), "relay new blocks as compact blocks, reconstructed from the tx pool, with the peers that support it")
             (cli::NONCEPREFIX_DIGITS, po::value<unsigned>()->default_value(0), "number of hex digits for nonce prefix for stratum client (0..6)")
             (cli::NODE_PEER, po::value<vector<string>>()->multitoken(), "nodes to connect to")
             (cli::NODE_PEERS_PERSISTENT, po::value<bool>()->default_value(false), "Keep persistent connection to the specified peers, regardless to ratings")
@@ -423,6 +433,8 @@ namespace beam
             (cli::MANUAL_SELECT, po::value<std::string>(), "Explicit correct block selection at the specified height. Auto-rollback below this height if current branch is different")
             (cli::CHECKDB, po::value<bool>()->default_value(false), "DB integrity check")
             (cli::VACUUM, po::value<bool>()->default_value(false), "DB vacuum (compact)")
+            (cli::IMAGE_CHECKPOINT_PERIOD, po::value<uint32_t>()->default_value(0), "period (in blocks) for the mapped image checkpoints, used to speed-up deep rollbacks. 0 = disabled")
+            (cli::IMAGE_CHECKPOINT_COPY, po::value<bool>()->default_value(false), "make full copies for the image checkpoints if the filesystem doesn't support reflinks (blocks the node while copying). Otherwise the checkpoints are disabled")
             (cli::BBS_ENABLE, po::value<bool>()->default_value(true), "Enable SBBS messaging")
             (cli::CRASH, po::value<int>()->default_value(0), "Induce crash (test proper handling)")
             (cli::OWNER_KEY, po::value<string>(), "Owner viewer key")
@@ -437,8 +449,11 @@ namespace beam
             (cli::OWNER_KEY_REMOVE_EP, po::value<vector<string> >(), "Remove extra Owner key")
             (cli::OWNER_KEY_REMOVE_ALL, po::value<bool>()->default_value(false), "Remove all extra owner keys")
             (cli::LOG_UTXOS, po::value<bool>()->default_value(false), "Log recovered UTXOs (make sure the log file is not exposed)")
+            (cli::LOG_TRAFIC_STATS, po::value<uint32_t>()->default_value(0), "period (in seconds) of logging the traffic and handling time summary per message type and peer (0 = disabled)")
             (cli::FAST_SYNC, po::value<bool>(), "Fast sync on/off (override horizons)")
             (cli::GENERATE_RECOVERY_PATH, po::value<string>(), "Recovery file to generate immediately after start")
+            (cli::SNAPSHOT_EXPORT_PATH, po::value<string>(), "State snapshot file to generate immediately after start")
+            (cli::SNAPSHOT_IMPORT_PATH, po::value<string>(), "State snapshot file to bootstrap the empty node from")
             (cli::RECOVERY_AUTO_PATH, po::value<string>(), "path and file prefix for recovery auto-generation")
             (cli::RECOVERY_AUTO_PERIOD, po::value<uint32_t>()->default_value(30), "period (in blocks) for recovery auto-generation")
             (cli::CONTRACT_RICH_INFO, po::value<bool>(), "Set to save rich contract invocation info")
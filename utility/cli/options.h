@@ -48,6 +48,8 @@ namespace beam
         extern const char* MINING_THREADS;
         extern const char* POW_SOLVE_TIME;
         extern const char* VERIFICATION_THREADS;
+        extern const char* DECODER_THREADS;
+        extern const char* COMPACT_BLOCKS;
         extern const char* NONCEPREFIX_DIGITS;
         extern const char* NODE_PEER;
         extern const char* NODE_PEERS_PERSISTENT;
@@ -87,6 +89,8 @@ namespace beam
         extern const char* CONTRACT_RICH_PARSER;
         extern const char* CHECKDB;
         extern const char* VACUUM;
+        extern const char* IMAGE_CHECKPOINT_PERIOD;
+        extern const char* IMAGE_CHECKPOINT_COPY;
         extern const char* CRASH;
         extern const char* INIT;
         extern const char* RESTORE;
@@ -140,6 +144,7 @@ namespace beam
         extern const char* LOG_VERBOSE;
         extern const char* LOG_CLEANUP_DAYS;
         extern const char* LOG_UTXOS;
+        extern const char* LOG_TRAFIC_STATS;
         extern const char* VERSION;
         extern const char* VERSION_FULL;
         extern const char* GIT_COMMIT_HASH;
@@ -157,6 +162,8 @@ namespace beam
         extern const char* IP_WHITELIST;
         extern const char* FAST_SYNC;
         extern const char* GENERATE_RECOVERY_PATH;
+        extern const char* SNAPSHOT_EXPORT_PATH;
+        extern const char* SNAPSHOT_IMPORT_PATH;
         extern const char* RECOVERY_AUTO_PATH;
         extern const char* RECOVERY_AUTO_PERIOD;
         extern const char* SWAP_INIT;
@@ -221,6 +228,7 @@ namespace beam
         extern const char* API_ACL_PATH;
         extern const char* API_VERSION;
         extern const char* API_TCP_MAX_LINE;
+        extern const char* API_SHADER_WORKERS;
 
         // treasury
         extern const char* TR_OPCODE;
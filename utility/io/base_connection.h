@@ -35,6 +35,11 @@ public:
         return _stream->write(msg, flush);
     }
 
+    /// Sends messages written with flush=false
+    io::Result flush()  {
+        return _stream->flush();
+    }
+
     /// Shutdowns write side, waits for pending write requests to complete, but on reactor's side
     void shutdown()  {
         _stream->shutdown();
@@ -60,7 +65,15 @@ public:
     }
 
 	size_t get_Unsent() const {
-		return _stream->state().unsent;
+		return _stream->state().unsent + _stream->unflushed();
+	}
+
+	size_t get_Unflushed() const {
+		return _stream->unflushed();
+	}
+
+	uint64_t get_Received() const {
+		return _stream->state().received;
 	}
 
 protected:
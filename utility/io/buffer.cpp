@@ -15,6 +15,7 @@
 #include "buffer.h"
 #include <string>
 #include <stdexcept>
+#include <atomic>
 
 #ifdef WIN32
     #define WIN32_LEAN_AND_MEAN
@@ -34,25 +35,164 @@ struct AllocatedMemory {
     virtual ~AllocatedMemory() {}
 };
 
-struct HeapAllocatedMemory : AllocatedMemory {
-    explicit HeapAllocatedMemory(size_t s) {
-        size = s;
-        if (size) {
-            data = malloc(size);
-            if (!data) throw std::runtime_error("HeapAllocatedMemory: out of memory");
+// The data follows the control block of the shared_ptr, within the same allocation
+struct PooledMemory : AllocatedMemory {
+};
+
+namespace {
+
+std::atomic<uint64_t> g_nAllocs(0), g_nHits(0), g_nFrees(0), g_nReleased(0);
+
+class FragmentCache {
+    static constexpr size_t s_Shift0 = 6; // min class size
+    static constexpr size_t s_ShiftMax = 16; // max cached size
+    static constexpr size_t s_Classes = (s_ShiftMax - s_Shift0) * 4 + 1;
+    static constexpr size_t s_BytesMax = 0x400000; // cached per thread
+
+    struct Node {
+        Node* next;
+    };
+
+    Node* _top[s_Classes] = { };
+    size_t _bytes = 0;
+    bool _dead = false;
+
+    /// Returns class index, and adjusts the size to the class size. Or s_Classes if not cached
+    static size_t get_class(size_t& size) {
+        if (size <= (size_t(1) << s_Shift0)) {
+            size = size_t(1) << s_Shift0;
+            return 0;
+        }
+        if (size > (size_t(1) << s_ShiftMax))
+            return s_Classes;
+
+        // 2^k < size <= 2^(k+1), 4 classes within
+        size_t k = s_Shift0;
+        while ((size - 1) >> (k + 1))
+            k++;
+
+        size_t step = size_t(1) << (k - 2);
+        size_t j = (size - (size_t(1) << k) + step - 1) >> (k - 2);
+        size = (size_t(1) << k) + j * step;
+        return (k - s_Shift0) * 4 + j;
+    }
+
+    void* alloc_internal(size_t size) {
+        g_nAllocs.fetch_add(1, std::memory_order_relaxed);
+
+        size_t iClass = get_class(size);
+        if ((iClass < s_Classes) && _top[iClass]) {
+            Node* p = _top[iClass];
+            _top[iClass] = p->next;
+            _bytes -= size;
+            g_nHits.fetch_add(1, std::memory_order_relaxed);
+            return p;
+        }
+
+        void* p = malloc(size);
+        if (!p) throw std::runtime_error("FragmentPool: out of memory");
+        return p;
+    }
+
+    void free_internal(void* p, size_t size) {
+        g_nFrees.fetch_add(1, std::memory_order_relaxed);
+
+        size_t iClass = get_class(size);
+        if ((iClass < s_Classes) && !_dead && (_bytes + size <= s_BytesMax)) {
+            Node* pNode = static_cast<Node*>(p);
+            pNode->next = _top[iClass];
+            _top[iClass] = pNode;
+            _bytes += size;
         } else {
-            data = 0;
+            g_nReleased.fetch_add(1, std::memory_order_relaxed);
+            free(p);
         }
     }
 
-    ~HeapAllocatedMemory() {
-        if (data) free(data);
+    static thread_local FragmentCache t_Cache;
+
+public:
+
+    ~FragmentCache() {
+        trim();
+        _dead = true; // buffers may still be released later, during the thread cleanup
+    }
+
+    void trim() {
+        for (size_t i = 0; i < s_Classes; i++) {
+            while (_top[i]) {
+                Node* p = _top[i];
+                _top[i] = p->next;
+                g_nReleased.fetch_add(1, std::memory_order_relaxed);
+                free(p);
+            }
+        }
+        _bytes = 0;
     }
 
-    size_t size;
-    void* data;
+    static void* alloc(size_t size) {
+        return t_Cache.alloc_internal(size);
+    }
+
+    static void release(void* p, size_t size) {
+        t_Cache.free_internal(p, size);
+    }
+
+    static FragmentCache& get() {
+        return t_Cache;
+    }
 };
 
+thread_local FragmentCache FragmentCache::t_Cache;
+
+/// Allocates the shared_ptr control block (which contains PooledMemory object) with the data appended
+template <typename T>
+struct PooledAllocator {
+    typedef T value_type;
+
+    size_t extra;
+    uint8_t** ppData;
+
+    PooledAllocator(size_t _extra, uint8_t** _ppData) : extra(_extra), ppData(_ppData) {}
+
+    template <typename U>
+    PooledAllocator(const PooledAllocator<U>& x) : extra(x.extra), ppData(x.ppData) {}
+
+    static size_t get_hdr_size(size_t n) {
+        constexpr size_t nAlign = 16;
+        return (sizeof(T) * n + nAlign - 1) / nAlign * nAlign;
+    }
+
+    T* allocate(size_t n) {
+        size_t nHdr = get_hdr_size(n);
+        uint8_t* p = static_cast<uint8_t*>(FragmentCache::alloc(nHdr + extra));
+        *ppData = extra ? (p + nHdr) : nullptr;
+        return reinterpret_cast<T*>(p);
+    }
+
+    void deallocate(T* p, size_t n) {
+        FragmentCache::release(p, get_hdr_size(n) + extra);
+    }
+
+    template <typename U> bool operator == (const PooledAllocator<U>& x) const { return extra == x.extra; }
+    template <typename U> bool operator != (const PooledAllocator<U>& x) const { return extra != x.extra; }
+};
+
+} // namespace
+
+FragmentPool::Stats FragmentPool::get_stats() {
+    Stats s;
+    s.allocs = g_nAllocs.load(std::memory_order_relaxed);
+    s.hits = g_nHits.load(std::memory_order_relaxed);
+    s.frees = g_nFrees.load(std::memory_order_relaxed);
+    s.released = g_nReleased.load(std::memory_order_relaxed);
+    return s;
+}
+
+void FragmentPool::trim() {
+    FragmentCache::get().trim();
+}
+
 #ifdef WIN32
 
 struct ReadOnlyMappedFileWin32 : AllocatedMemory {
@@ -138,9 +278,7 @@ struct ReadOnlyMappedFile : AllocatedMemory {
 
 std::pair<uint8_t*, SharedMem> alloc_heap(size_t size) {
     std::pair<uint8_t*, SharedMem> p;
-    HeapAllocatedMemory* mem = new HeapAllocatedMemory(size);
-    p.first = (uint8_t*)mem->data;
-    p.second.reset(mem);
+    p.second = std::allocate_shared<PooledMemory>(PooledAllocator<PooledMemory>(size, &p.first));
     return p;
 }
 
@@ -91,8 +91,27 @@ struct IOVec {
 using SharedMem = std::shared_ptr<struct AllocatedMemory>;
 
 /// Allocs shared memory from heap, throws on error
+/// The data and its guard are allocated at once, from the per-thread FragmentPool cache
 std::pair<uint8_t*, SharedMem> alloc_heap(size_t size);
 
+/// Per-thread cache of recently freed heap blocks for shared buffers, by size classes (4 per power of 2, up to 64K).
+/// Outgoing message fragments are mostly allocated and freed on the same (reactor) thread, so that
+/// in the steady state serialization doesn't hit the allocator
+struct FragmentPool {
+    struct Stats {
+        uint64_t allocs = 0;    // total allocations
+        uint64_t hits = 0;      // of them served from the cache
+        uint64_t frees = 0;     // total deallocations
+        uint64_t released = 0;  // of them returned to the heap (cache full, block too large, or trimmed)
+    };
+
+    /// Counters summed over all threads
+    static Stats get_stats();
+
+    /// Returns all the blocks cached by the current thread to the heap
+    static void trim();
+};
+
 struct SharedBuffer : IOVec {
     SharedMem guard;
 
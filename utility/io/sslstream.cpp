@@ -33,6 +33,10 @@ Result SslStream::write(const SerializedMsg& fragments, bool flush) {
     return flush ? _ssl.flush() : Ok();
 }
 
+Result SslStream::flush() {
+    return _ssl.flush();
+}
+
 void SslStream::shutdown() {
     //_ssl.flush();
     _ssl.shutdown();
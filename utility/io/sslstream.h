@@ -29,6 +29,8 @@ public:
     /// Writes raw data, returns status code
     Result write(const SerializedMsg& fragments, bool flush=true) override;
 
+    Result flush() override;
+
     /// Shutdowns write side, waits for pending write requests to complete, but on reactor's side
     void shutdown() override;
 
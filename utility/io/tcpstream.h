@@ -62,6 +62,14 @@ public:
     /// Writes raw data, returns status code
     //virtual Result write(const BufferChain& fragments, bool flush=true);
 
+    /// Sends the data written with flush=false, all in a single write request
+    virtual Result flush();
+
+    /// Size of the data written with flush=false, not sent yet
+    size_t unflushed() const {
+        return _writeBuffer.size();
+    }
+
     /// Shutdowns write side, waits for pending write requests to complete, but on reactor's side
     virtual void shutdown();
 
@@ -162,7 +162,8 @@ namespace
                         io::Address listenTo,
                         const ConnectionOptions& connectionOptions,
                         ApiACL acl,
-                        const std::vector<uint32_t>& whitelist)
+                        const std::vector<uint32_t>& whitelist,
+                        uint32_t shaderWorkers)
 
             : _apiVersion(apiVersion)
             , _reactor(reactor)
@@ -173,6 +174,7 @@ namespace
             , _network(nnet)
             , _acl(acl)
             , _whitelist(whitelist)
+            , _shaderWorkers(shaderWorkers)
         {
             start();
         }
@@ -337,7 +339,7 @@ namespace
                 _walletData->walletDB    = _walletDB;
                 _walletData->wallet      = _wallet;
                 _walletData->acl         = _acl;
-                _walletData->contracts   = IShadersManager::CreateInstance(*_wallet, "", "", 0);
+                _walletData->contracts   = IShadersManager::CreateInstance(*_wallet, "", "", 0, _shaderWorkers);
                 _walletData->nodeNetwork = _network;
 
                 #ifdef BEAM_ATOMIC_SWAP_SUPPORT
@@ -618,6 +620,7 @@ namespace
         std::vector<uint64_t> _pendingToClose;
         ApiACL _acl;
         std::vector<uint32_t> _whitelist;
+        uint32_t _shaderWorkers;
 
         std::set<Asset::ID> _assetsFullList = {Asset::s_BeamID};
 
@@ -663,6 +666,7 @@ int main(int argc, char* argv[])
         uint32_t logCleanupPeriod;
         bool enableLelantus = false;
         bool enableBodyRequests = false;
+        uint32_t shaderWorkers;
     } options;
     ConnectionOptions connectionOptions;
 
@@ -688,6 +692,7 @@ int main(int argc, char* argv[])
             (cli::LOG_CLEANUP_DAYS, po::value<uint32_t>()->default_value(5), "old logfiles cleanup period(days)")
             (cli::API_TCP_MAX_LINE, po::value<size_t>(&connectionOptions.maxLineSize)->default_value(65536), "max line size in TCP mode")
             (cli::REQUEST_BODIES,   po::value<bool>(&options.enableBodyRequests)->default_value(false), "request and parse block bodies on the wallet side")
+            (cli::API_SHADER_WORKERS, po::value<uint32_t>(&options.shaderWorkers)->default_value(1), "max number of app shader calls executed simultaneously")
         ;
 
         po::options_description authDesc("User authorization options");
@@ -901,7 +906,7 @@ int main(int argc, char* argv[])
         wallet->AddMessageEndpoint(wnet);
         wallet->SetNodeEndpoint(nnet);
 
-        WalletApiServer server(options.apiVersion, walletDB, wallet, nnet, *reactor, listenTo, connectionOptions, acl, whitelist);
+        WalletApiServer server(options.apiVersion, walletDB, wallet, nnet, *reactor, listenTo, connectionOptions, acl, whitelist, options.shaderWorkers);
 
         #ifdef BEAM_ATOMIC_SWAP_SUPPORT
         RegisterSwapTxCreators(wallet, walletDB);
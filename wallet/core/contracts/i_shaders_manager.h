@@ -29,7 +29,8 @@ namespace beam::wallet
         typedef std::shared_ptr<IShadersManager> Ptr;
         typedef std::weak_ptr<IShadersManager> WeakPtr;
 
-        static Ptr CreateInstance(Wallet&, std::string appid, std::string appname, uint32_t privilegeLvl);
+        // nWorkers - max number of shader calls in progress simultaneously
+        static Ptr CreateInstance(Wallet&, std::string appid, std::string appname, uint32_t privilegeLvl, uint32_t nWorkers = 1);
 
         virtual ~IShadersManager() = default;
 
@@ -39,6 +40,7 @@ namespace beam::wallet
         virtual void CallShaderAndStartTx(std::vector<uint8_t>&& shader, std::string&& args, unsigned method, uint32_t priority, uint32_t unique, DoneAllHandler doneHandler) = 0;
         virtual void CallShader(std::vector<uint8_t>&& shader, std::string&& args, unsigned method, uint32_t priority, uint32_t unique, DoneCallHandler) = 0;
         virtual void ProcessTxData(const ByteBuffer& data, DoneTxHandler doneHandler) = 0;
+        // true if a new call would start immediately
         [[nodiscard]] virtual  bool IsDone() const = 0;
     };
 }
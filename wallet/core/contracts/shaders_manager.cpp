@@ -198,34 +198,62 @@ namespace beam::wallet {
         return res;
     }
 
-    ShadersManager::ShadersManager(Wallet& wallet, std::string appid, std::string appname, uint32_t privilegeLvl)
-        : ManagerStdInWallet(wallet)
+    ShadersManager::ShadersManager(Wallet& wallet, std::string appid, std::string appname, uint32_t privilegeLvl, uint32_t nWorkers)
+        : _wallet(wallet)
         , _currentAppId(std::move(appid))
         , _currentAppName(std::move(appname))
     {
         _logResult = appid.empty();
+
+        _workers.resize(std::max(nWorkers, 1u));
+        for (auto& pWorker : _workers)
+            pWorker = std::make_unique<Worker>(*this, privilegeLvl);
+    }
+
+    ShadersManager::Worker::Worker(ShadersManager& x, uint32_t privilegeLvl)
+        : ManagerStdInWallet(x._wallet)
+        , m_This(x)
+    {
         set_Privilege(privilegeLvl);
     }
 
-    void ShadersManager::compileAppShader(const std::vector<uint8_t> &shader)
+    bool ShadersManager::IsDone() const
     {
-        if (!_done)
-        {
-            assert(false);
-            throw std::runtime_error("still in shader call");
-        }
+        return _queue.empty() && findIdleWorker();
+    }
+
+    ShadersManager::Worker* ShadersManager::findIdleWorker() const
+    {
+        for (const auto& pWorker : _workers)
+            if (!pWorker->m_Busy)
+                return pWorker.get();
+
+        return nullptr;
+    }
 
+    void ShadersManager::Request::Fail(std::string&& error)
+    {
+        if (doneAll)
+            doneAll(boost::none, boost::none, std::move(error));
+        else
+            doneCall(boost::none, boost::none, std::move(error));
+    }
+
+    void ShadersManager::compileAppShader(const std::vector<uint8_t> &shader)
+    {
         if (shader.empty())
         {
             assert(false);
             throw std::runtime_error("empty code buffer in ::Compile");
         }
 
-        auto &resBuffer = m_BodyManager;
         beam::Blob shaderBlob(shader);
 
         // this throws
-        beam::bvm2::Processor::Compile(resBuffer, shaderBlob, ManagerStd::Kind::Manager);
+        ByteBuffer resBuffer;
+        beam::bvm2::Processor::Compile(resBuffer, shaderBlob, bvm2::Processor::Kind::Manager);
+
+        _appShader = std::move(resBuffer);
     }
 
     void ShadersManager::pushRequest(Request newReq)
@@ -239,6 +267,14 @@ namespace beam::wallet {
                     return;
                 }
             }
+
+            for (const auto& pWorker : _workers)
+            {
+                if (pWorker->m_Busy && (pWorker->m_Req.unique == newReq.unique))
+                {
+                    return;
+                }
+            }
         }
         _queue.push(std::move(newReq));
     }
@@ -254,7 +290,7 @@ namespace beam::wallet {
         req.unique   = unique;
         pushRequest(std::move(req));
 
-        if (_done)
+        if (findIdleWorker())
         {
             return nextRequest();
         }
@@ -273,7 +309,7 @@ namespace beam::wallet {
         req.unique   = unique;
         pushRequest(std::move(req));
 
-        if (_done)
+        if (findIdleWorker())
         {
             return nextRequest();
         }
@@ -283,49 +319,62 @@ namespace beam::wallet {
 
     void ShadersManager::nextRequest()
     {
-        if (_queue.empty())
+        while (!_queue.empty())
         {
-            return;
-        }
+            auto* pWorker = findIdleWorker();
+            if (!pWorker)
+            {
+                return;
+            }
 
-        const auto& req = _queue.top();
-        if (!req.shader.empty())
-        {
-            try
+            Request req = std::move(const_cast<Request&>(_queue.top()));
+            _queue.pop();
+
+            if (!req.shader.empty())
             {
-                compileAppShader(req.shader);
+                try
+                {
+                    compileAppShader(req.shader);
+                }
+                catch(std::exception& ex)
+                {
+                    req.Fail(std::string(ex.what()));
+                    continue;
+                }
             }
-            catch(std::exception& ex)
+
+            if (_appShader.empty())
             {
-                BOOST_SCOPE_EXIT_ALL(&, this) {
-                    _queue.pop();
-                };
-                return req.doneCall(boost::none, boost::none, std::string(ex.what()));
+                req.Fail(std::string("missing shader code"));
+                continue;
             }
-        }
 
-        if (m_BodyManager.empty())
-        {
-            BOOST_SCOPE_EXIT_ALL(&, this) {
-                _queue.pop();
-            };
-            return req.doneCall(boost::none, boost::none, std::string("missing shader code"));
+            pWorker->Start(std::move(req));
         }
+    }
+
+    void ShadersManager::Worker::Start(Request&& req)
+    {
+        assert(!m_Busy);
+        m_Busy = true;
+        m_Req = std::move(req);
+        m_Req.shader.clear(); // already compiled
+
+        m_BodyManager = m_This._appShader;
 
         m_Args.clear();
-        if (!req.args.empty())
+        if (!m_Req.args.empty())
         {
-            AddArgs(req.args);
+            AddArgs(m_Req.args);
         }
 
-        _done = false;
-        _startEvent = io::AsyncEvent::create(io::Reactor::get_Current(),
-            [this, method = req.method]()
+        m_pStartEvent = io::AsyncEvent::create(io::Reactor::get_Current(),
+            [this, method = m_Req.method]()
             {
                 StartRun(method);
             });
 
-        m_Wallet.DoInSyncedWallet([wp = std::weak_ptr(_startEvent)]()
+        m_Wallet.DoInSyncedWallet([wp = std::weak_ptr(m_pStartEvent)]()
             {
                 if (auto sp = wp.lock())
                     sp->post();
@@ -368,7 +417,7 @@ namespace beam::wallet {
                 params.SetParameter(TxParameterID::AppName, _currentAppName);
             }
 
-            auto txid = m_Wallet.StartTransaction(params);
+            auto txid = _wallet.StartTransaction(params);
             return doneHandler(txid, boost::none);
         }
         catch(const std::runtime_error& err)
@@ -378,47 +427,41 @@ namespace beam::wallet {
         }
     }
 
-    void ShadersManager::OnDone(const std::exception *pExc)
+    void ShadersManager::Worker::OnDone(const std::exception *pExc)
     {
-        if (_queue.empty())
+        if (!m_Busy)
         {
-            BEAM_LOG_WARNING() << "Queue has been cleared before request completed";
+            BEAM_LOG_WARNING() << "Shader call completed without a pending request";
             return;
         }
 
-        BOOST_SCOPE_EXIT_ALL(&, this) {
-            _queue.pop();
-            this->nextRequest();
-        };
+        // release the worker before invoking the handlers, they may issue new calls
+        Request req = std::move(m_Req);
+        m_Busy = false;
 
-        _done = true;
-        const auto& req = _queue.top();
+        auto& x = m_This;
+        BOOST_SCOPE_EXIT_ALL(&x) {
+            x.nextRequest();
+        };
 
         if (pExc != nullptr)
         {
-            boost::optional<std::string> error = boost::none;
+            std::string error;
             if (pExc->what() && pExc->what()[0] != 0)
             {
-                error = std::string(pExc->what());
+                error = pExc->what();
             }
             else
             {
-                error = std::string("unknown error");
+                error = "unknown error";
             }
 
-            BEAM_LOG_INFO() << "Shader Error: " << *error;
-            if (req.doneAll)
-            {
-                return req.doneAll(boost::none, boost::none, std::move(error));
-            }
-            else
-            {
-                return req.doneCall(boost::none, boost::none, std::move(error));
-            }
+            BEAM_LOG_INFO() << "Shader Error: " << error;
+            return req.Fail(std::move(error));
         }
 
         boost::optional<std::string> result = m_Out.str();
-        if (_logResult)
+        if (x._logResult)
         {
             BEAM_LOG_VERBOSE () << "Shader result: " << std::string_view(result ? *result : std::string()).substr(0, 200);
         }
@@ -444,7 +487,7 @@ namespace beam::wallet {
                 return req.doneCall(std::move(buffer), std::move(result), boost::none);
             }
 
-            return ProcessTxData(buffer, [result=std::move(result), allHandler = std::move(req.doneAll)](const boost::optional<TxID>& txid, boost::optional<std::string>&& error) mutable
+            return x.ProcessTxData(buffer, [result=std::move(result), allHandler = std::move(req.doneAll)](const boost::optional<TxID>& txid, boost::optional<std::string>&& error) mutable
             {
                 return allHandler(txid, std::move(result), std::move(error));
             });
@@ -463,8 +506,8 @@ namespace beam::wallet {
         }
     }
 
-    IShadersManager::Ptr IShadersManager::CreateInstance(Wallet& wallet, std::string appid, std::string appname,uint32_t privilegeLvl)
+    IShadersManager::Ptr IShadersManager::CreateInstance(Wallet& wallet, std::string appid, std::string appname, uint32_t privilegeLvl, uint32_t nWorkers)
     {
-        return std::make_shared<ShadersManager>(wallet, std::move(appid), std::move(appname), privilegeLvl);
+        return std::make_shared<ShadersManager>(wallet, std::move(appid), std::move(appname), privilegeLvl, nWorkers);
     }
 }
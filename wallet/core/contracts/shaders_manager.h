@@ -56,35 +56,27 @@ namespace beam::wallet {
 
     class ShadersManager
         : public IShadersManager
-        , private ManagerStdInWallet
     {
     public:
-        ShadersManager(Wallet&, std::string appid, std::string appname, uint32_t privilegeLvl);
+        ShadersManager(Wallet&, std::string appid, std::string appname, uint32_t privilegeLvl, uint32_t nWorkers = 1);
 
-        bool IsDone() const override
-        {
-            return _done;
-        }
+        bool IsDone() const override;
 
         void CallShaderAndStartTx(std::vector<uint8_t>&& shader, std::string&& args, unsigned method, uint32_t priority, uint32_t unique, DoneAllHandler doneHandler) override;
         void CallShader(std::vector<uint8_t>&& shader, std::string&& args, unsigned method, uint32_t priority, uint32_t unique, DoneCallHandler) override;
         void ProcessTxData(const ByteBuffer& data, DoneTxHandler doneHandler) override;
 
-    protected:
-        void OnDone(const std::exception *pExc) override;
-
     private:
         void nextRequest();
 
         // this one throws
         void compileAppShader(const std::vector<uint8_t> &shader);
 
-        bool _done = true;
+        Wallet& _wallet;
         bool _logResult = true;
         std::string _currentAppId;
         std::string _currentAppName;
-
-        beam::io::AsyncEvent::Ptr _startEvent;
+        ByteBuffer _appShader; // last compiled, used by requests that don't specify the shader
 
         struct Request {
             uint32_t unique = 0;
@@ -100,8 +92,29 @@ namespace beam::wallet {
             {
                 return priority < rhs.priority;
             }
+
+            void Fail(std::string&& error);
         };
 
+        // Each worker has its own processor instance. All run on the wallet reactor thread, the concurrency is
+        // between the shaders suspended on node requests (or Comm_Wait).
+        struct Worker
+            : public ManagerStdInWallet
+        {
+            Worker(ShadersManager&, uint32_t privilegeLvl);
+
+            ShadersManager& m_This;
+            bool m_Busy = false;
+            Request m_Req;
+            io::AsyncEvent::Ptr m_pStartEvent;
+
+            void Start(Request&&);
+            void OnDone(const std::exception *pExc) override;
+        };
+
+        std::vector<std::unique_ptr<Worker> > _workers;
+
+        Worker* findIdleWorker() const;
         void pushRequest(Request req);
 
         struct RequestsQueue: std::priority_queue<Request> {
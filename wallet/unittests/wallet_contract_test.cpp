@@ -96,7 +96,7 @@ namespace
         , const std::string& contractShader
         , std::string args)
     {
-        MyManager man(walletDB, wallet);
+        MyManager man(*wallet);
 
         if (appShader.empty())
             throw std::runtime_error("shader file not specified");
@@ -126,7 +126,7 @@ namespace
             }
         }
 
-        if (man.m_Err || man.m_InvokeData.empty())
+        if (man.m_Err || man.m_InvokeData.m_vec.empty())
             return false;
 
         wallet->StartTransaction(
@@ -139,7 +139,8 @@ namespace
     class TestLocalNode : private Node::IObserver
     {
     public:
-        TestLocalNode(const ByteBuffer& binaryTreasury
+        TestLocalNode(Rules& r
+            , const ByteBuffer& binaryTreasury
             , Key::IKdf::Ptr pKdf
             , uint16_t port = 32125
             , const std::string& path = "mytest.db"
@@ -147,7 +148,7 @@ namespace
         )
         {
             m_Node.m_Cfg.m_Treasury = binaryTreasury;
-            ECC::Hash::Processor() << Blob(m_Node.m_Cfg.m_Treasury) >> Rules::get().TreasuryChecksum;
+            ECC::Hash::Processor() << Blob(m_Node.m_Cfg.m_Treasury) >> r.TreasuryChecksum;
 
             boost::filesystem::remove(path);
             m_Node.m_Cfg.m_sPathLocal = path;
@@ -243,14 +244,14 @@ namespace
     };
 }
 
-void TestNode()
+void TestNode(Rules& r)
 {
     auto walletDB = createWalletDB("wallet.db", true);
     auto binaryTreasury = createTreasury(walletDB, {});
     auto walletDB2 = createWalletDB("wallet2.db", true);
 
-    TestLocalNode nodeA{ binaryTreasury, walletDB->get_MasterKdf() };
-    TestLocalNode nodeB{ binaryTreasury, walletDB2->get_MasterKdf(), 32126, "mytest2.db", {io::Address::localhost().port(32125)} };
+    TestLocalNode nodeA{ r, binaryTreasury, walletDB->get_MasterKdf() };
+    TestLocalNode nodeB{ r, binaryTreasury, walletDB2->get_MasterKdf(), 32126, "mytest2.db", {io::Address::localhost().port(32125)} };
 
     nodeA.GenerateBlocks(10);
     nodeB.GenerateBlocks(15);
@@ -280,12 +281,12 @@ void TestNode()
     checkCoins(walletDB2, 15, 32126);
 }
 
-void TestContract()
+void TestContract(Rules& r)
 {
     auto walletDB = createWalletDB("wallet.db", true);
     auto binaryTreasury = createTreasury(walletDB, {});
 
-    TestLocalNode nodeA{ binaryTreasury, walletDB->get_MasterKdf() };
+    TestLocalNode nodeA{ r, binaryTreasury, walletDB->get_MasterKdf() };
     auto w = std::make_shared<Wallet>(walletDB);
     MyObserver observer;
     ScopedSubscriber<wallet::IWalletObserver, wallet::Wallet> ws(&observer, w);
@@ -308,6 +309,89 @@ void TestContract()
     WALLET_CHECK(tx[0].m_status == TxStatus::Completed);
 }
 
+void TestShadersManagerWorkers(Rules& r)
+{
+    auto walletDB = createWalletDB("wallet.db", true);
+    auto binaryTreasury = createTreasury(walletDB, {});
+
+    TestLocalNode nodeA{ r, binaryTreasury, walletDB->get_MasterKdf() };
+    nodeA.GenerateBlocks(2);
+
+    auto w = std::make_shared<Wallet>(walletDB);
+    auto nodeEndpoint = make_shared<MyNetwork>(*w);
+    nodeEndpoint->m_Cfg.m_PollPeriod_ms = 0;
+    nodeEndpoint->m_Cfg.m_vNodes.push_back(io::Address::localhost().port(32125));
+    nodeEndpoint->Connect();
+    w->SetNodeEndpoint(nodeEndpoint);
+
+    ByteBuffer shader;
+    {
+        std::FStream fs;
+        fs.Open("test_app.wasm", true, true);
+        shader.resize(static_cast<size_t>(fs.get_Remaining()));
+        if (!shader.empty())
+            fs.read(&shader.front(), shader.size());
+    }
+
+    ShadersManager sm(*w, "", "", 0, 3);
+
+    struct Result
+    {
+        uint32_t m_Calls = 0;
+        boost::optional<std::string> m_Output;
+        boost::optional<std::string> m_Error;
+    };
+
+    const uint32_t nExpected = 4;
+    uint32_t nCalls = 0;
+
+    auto fnHandler = [&nCalls](Result& res)
+    {
+        return [&res, &nCalls](boost::optional<ByteBuffer>&&, boost::optional<std::string>&& output, boost::optional<std::string>&& error)
+        {
+            res.m_Calls++;
+            res.m_Output = std::move(output);
+            res.m_Error = std::move(error);
+
+            if (++nCalls == nExpected)
+                io::Reactor::get_Current().stop();
+        };
+    };
+
+    Result resScheme, resAction, resRole, resDup, resBad;
+
+    // 3 workers: the first 3 calls are dispatched at once, the rest wait in the queue
+    sm.CallShader(ByteBuffer(shader), "", 0, 0, 0, fnHandler(resScheme));
+    sm.CallShader(ByteBuffer(shader), "role=manager,action=none", 1, 0, 0, fnHandler(resAction));
+    sm.CallShader(ByteBuffer(shader), "role=none,action=none", 1, 0, 7, fnHandler(resRole));
+    sm.CallShader(ByteBuffer(shader), "role=none,action=none", 1, 0, 7, fnHandler(resDup)); // same unique, dropped
+    sm.CallShader(ByteBuffer{ 1, 2, 3 }, "", 0, 0, 0, fnHandler(resBad)); // fails to compile
+
+    WALLET_CHECK(!sm.IsDone());
+
+    io::Timer::Ptr timer = io::Timer::create(io::Reactor::get_Current());
+    timer->start(30000, false, []() { io::Reactor::get_Current().stop(); });
+
+    io::Reactor::get_Current().run();
+
+    WALLET_CHECK(nCalls == nExpected);
+    WALLET_CHECK(sm.IsDone());
+
+    WALLET_CHECK(resScheme.m_Calls == 1);
+    WALLET_CHECK(!resScheme.m_Error && resScheme.m_Output && resScheme.m_Output->find("roles") != std::string::npos);
+
+    WALLET_CHECK(resAction.m_Calls == 1);
+    WALLET_CHECK(!resAction.m_Error && resAction.m_Output && resAction.m_Output->find("invalid Action") != std::string::npos);
+
+    WALLET_CHECK(resRole.m_Calls == 1);
+    WALLET_CHECK(!resRole.m_Error && resRole.m_Output && resRole.m_Output->find("unknown Role") != std::string::npos);
+
+    WALLET_CHECK(resDup.m_Calls == 0);
+
+    WALLET_CHECK(resBad.m_Calls == 1);
+    WALLET_CHECK(resBad.m_Error && !resBad.m_Output);
+}
+
 int main()
 {
     const auto logLevel = BEAM_LOG_LEVEL_DEBUG;
@@ -315,15 +399,19 @@ int main()
     io::Reactor::Ptr reactor{ io::Reactor::create() };
     io::Reactor::Scope scope(*reactor);
 
-    Rules::get().FakePoW = true;
-    Rules::get().Maturity.Coinbase = 0;
-    Rules::get().pForks[1].m_Height = 1;
-    Rules::get().pForks[2].m_Height = 1;
-    Rules::get().pForks[3].m_Height = 1;
-    Rules::get().UpdateChecksum();
+    Rules r;
+    Rules::Scope scopeRules(r);
+
+    r.m_Consensus = Rules::Consensus::FakePoW;
+    r.Maturity.Coinbase = 0;
+    r.pForks[1].m_Height = 1;
+    r.pForks[2].m_Height = 1;
+    r.pForks[3].m_Height = 1;
+    r.UpdateChecksum();
 
-    TestContract();
-    TestNode();
+    TestContract(r);
+    TestNode(r);
+    TestShadersManagerWorkers(r);
 
     
     return WALLET_CHECK_RESULT;